@@ -0,0 +1,40 @@
+#include "alloc_counter.h"
+
+#include "../brick_game/common/alloc_stats.h"
+
+namespace s21 {
+namespace bench {
+
+/**
+ * @brief Количество выделений памяти с начала работы программы.
+ *
+ * Выделения считает CommonAllocStats: бенчмарк собирается с модулем
+ * alloc_stats в сборке ALLOC_STATS, а код игр - без фаз ALLOC_PHASE,
+ * поэтому все выделения попадают в ALLOC_IDLE.
+ *
+ * @return uint64_t Счетчик выделений.
+ */
+uint64_t AllocCount() noexcept {
+  AllocStats_t stats;
+  allocStatsTake(&stats);
+  uint64_t count = 0;
+  for (int phase = 0; phase < ALLOC_PHASES; phase++) {
+    count += stats.count[phase];
+  }
+  return count;
+}
+
+/**
+ * @brief Записывает в бенчмарк счетчик allocs/op.
+ *
+ * @param state Состояние бенчмарка после цикла измерения.
+ * @param before Значение AllocCount перед циклом измерения.
+ */
+void ReportAllocs(benchmark::State &state, uint64_t before) noexcept {
+  state.counters["allocs/op"] = benchmark::Counter(
+      static_cast<double>(AllocCount() - before),
+      benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace bench
+}  // namespace s21
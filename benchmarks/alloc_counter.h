@@ -0,0 +1,29 @@
+#ifndef CPP3_BRICKGAME_SRC_BENCHMARKS_ALLOC_COUNTER_H_
+#define CPP3_BRICKGAME_SRC_BENCHMARKS_ALLOC_COUNTER_H_
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace s21 {
+namespace bench {
+
+/**
+ * @defgroup Benchmarks Benchmarks
+ * Микробенчмарки горячих функций Tetris и Snake (Google Benchmark).
+ *
+ * Каждый бенчмарк сообщает время одного вызова (ns/op) и счетчик allocs/op:
+ * сколько раз за вызов выделялась память (malloc, calloc, realloc, функции
+ * выделения с выравниванием и operator new, см. CommonAllocStats).
+ * @{
+ */
+
+uint64_t AllocCount() noexcept;
+void ReportAllocs(benchmark::State &state, uint64_t before) noexcept;
+
+/** @} */  // Benchmarks
+
+}  // namespace bench
+}  // namespace s21
+
+#endif  // CPP3_BRICKGAME_SRC_BENCHMARKS_ALLOC_COUNTER_H_
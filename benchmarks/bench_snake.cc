@@ -0,0 +1,134 @@
+#include <vector>
+
+#include "../brick_game/snake/model/snake.h"
+#include "alloc_counter.h"
+
+namespace s21 {
+namespace bench {
+
+/**
+ * @brief Гамильтонов цикл по полю: змейка может ползти по нему бесконечно.
+ *
+ * Строки обходятся змейкой по столбцам 1..WIDTH-1, столбец 0 ведет от
+ * последней строки обратно к началу.
+ */
+struct SnakePath {
+  std::vector<Snake::SnakeElement> cells;  ///< Клетки цикла по порядку
+  std::vector<UserAction_t> moves;  ///< Направление из клетки к следующей
+
+  SnakePath() {
+    cells.push_back({0, 0});
+    for (int y = 0; y < HEIGHT; y++) {
+      for (int i = 1; i < WIDTH; i++) {
+        cells.push_back({y % 2 ? WIDTH - i : i, y});
+      }
+    }
+    for (int y = HEIGHT - 1; y > 0; y--) cells.push_back({0, y});
+    for (size_t i = 0; i < cells.size(); i++) {
+      const Snake::SnakeElement &from = cells[i];
+      const Snake::SnakeElement &to = cells[(i + 1) % cells.size()];
+      moves.push_back(to.x > from.x   ? Right
+                      : to.x < from.x ? Left
+                      : to.y > from.y ? Down
+                                      : Up);
+    }
+  }
+
+  /**
+   * @brief Змейка длины length, голова в клетке length - 1 цикла.
+   */
+  std::vector<Snake::SnakeElement> Body(size_t length) const {
+    return std::vector<Snake::SnakeElement>(cells.rend() - length,
+                                            cells.rend());
+  }
+};
+
+/**
+ * @brief Игра с идущей змейкой длины length на цикле path.
+ */
+static void PrepareSnake(Snake &game, const SnakePath &path, size_t length) {
+  game.SetSnake(path.Body(length));
+  game.SetDirection(path.moves[length - 1]);
+  game.gameInfo.pause = STARTED;
+}
+
+/**
+ * @brief Длины змейки, на которых запускаются бенчмарки Snake.
+ */
+static void SnakeLengths(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgName("length");
+  for (int length : {4, 32, 128, 192}) benchmark->Arg(length);
+}
+
+/**
+ * @brief MovingSnake: шаг змейки по циклу.
+ *
+ * Яблоко убрано за пределы поля, поэтому длина змейки не меняется.
+ */
+static void BM_MovingSnake(benchmark::State &state) {
+  SnakePath path;
+  Snake game(42);
+  size_t length = static_cast<size_t>(state.range(0));
+  PrepareSnake(game, path, length);
+  game.gameInfo.next[0][0] = -1;
+  game.gameInfo.next[0][1] = -1;
+  size_t head = length - 1;
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) {
+    game.SetDirection(path.moves[head]);
+    game.MovingSnake();
+    head = (head + 1) % path.cells.size();
+  }
+  ReportAllocs(state, allocs);
+  if (game.gameInfo.pause != STARTED) state.SkipWithError("snake stopped");
+}
+BENCHMARK(BM_MovingSnake)->Apply(SnakeLengths);
+
+/**
+ * @brief GenerateApple: выбор свободной клетки.
+ */
+static void BM_GenerateApple(benchmark::State &state) {
+  SnakePath path;
+  Snake game(42);
+  PrepareSnake(game, path, static_cast<size_t>(state.range(0)));
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) {
+    game.GenerateApple();
+    benchmark::DoNotOptimize(game.gameInfo.next[0][0]);
+  }
+  ReportAllocs(state, allocs);
+}
+BENCHMARK(BM_GenerateApple)->Apply(SnakeLengths);
+
+/**
+ * @brief AteSelf: проверка столкновения головы с телом.
+ */
+static void BM_AteSelf(benchmark::State &state) {
+  SnakePath path;
+  Snake game(42);
+  PrepareSnake(game, path, static_cast<size_t>(state.range(0)));
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) benchmark::DoNotOptimize(game.AteSelf());
+  ReportAllocs(state, allocs);
+}
+BENCHMARK(BM_AteSelf)->Apply(SnakeLengths);
+
+/**
+ * @brief CheckEndGame: проверка стен, столкновения и победы.
+ */
+static void BM_CheckEndGame(benchmark::State &state) {
+  SnakePath path;
+  Snake game(42);
+  PrepareSnake(game, path, static_cast<size_t>(state.range(0)));
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) {
+    game.CheckEndGame();
+    benchmark::DoNotOptimize(game.gameInfo.pause);
+  }
+  ReportAllocs(state, allocs);
+  if (game.gameInfo.pause != STARTED) state.SkipWithError("snake stopped");
+}
+BENCHMARK(BM_CheckEndGame)->Apply(SnakeLengths);
+
+}  // namespace bench
+}  // namespace s21
@@ -0,0 +1,136 @@
+#include "../brick_game/tetris/tetris_backend.h"
+#include "alloc_counter.h"
+
+namespace s21 {
+namespace bench {
+
+/**
+ * @brief Готовит игру с заполненной нижней частью поля.
+ *
+ * В каждой заполненной строке, кроме fullRows нижних, остается одна пустая
+ * клетка, поэтому такие строки не удаляются. Фигура стоит над полем, как
+ * после появления.
+ *
+ * @param game Игра (освобождается freeSpace).
+ * @param filledRows Количество заполненных строк снизу.
+ * @param fullRows Количество полностью заполненных строк снизу.
+ */
+static void PrepareGame(Tetris *game, int filledRows, int fullRows) {
+  initialGameSeeded(game, 42);
+  clearBoard(&game->board);
+  for (int i = 0; i < filledRows; i++) {
+    int hole = i < fullRows ? -1 : (i * 7 + 3) % WIDTH;
+    for (int j = 0; j < WIDTH; j++) {
+      if (j != hole) setBoardCell(game, HEIGHT - 1 - i, j, j % 7 + 1);
+    }
+  }
+}
+
+/**
+ * @brief isValidPosition для всех фигур на всех высотах поля.
+ */
+static void BM_IsValidPosition(benchmark::State &state) {
+  Tetris game;
+  PrepareGame(&game, static_cast<int>(state.range(0)), 0);
+  int step = 0;
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) {
+    game.figure.indexTetramino = step % TETROMINO_COUNT;
+    game.figure.y = step % HEIGHT - 2;
+    benchmark::DoNotOptimize(isValidPosition(&game, step % 3 - 1, 1));
+    step++;
+  }
+  ReportAllocs(state, allocs);
+  freeSpace(&game);
+}
+BENCHMARK(BM_IsValidPosition)->ArgName("filled")->DenseRange(0, 15, 5);
+
+/**
+ * @brief checkRotate для всех фигур на всех высотах поля.
+ */
+static void BM_CheckRotate(benchmark::State &state) {
+  Tetris game;
+  PrepareGame(&game, static_cast<int>(state.range(0)), 0);
+  int step = 0;
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) {
+    game.figure.indexTetramino = step % TETROMINO_COUNT;
+    game.figure.y = step % HEIGHT - 2;
+    benchmark::DoNotOptimize(checkRotate(&game));
+    step++;
+  }
+  ReportAllocs(state, allocs);
+  freeSpace(&game);
+}
+BENCHMARK(BM_CheckRotate)->ArgName("filled")->DenseRange(0, 15, 5);
+
+/**
+ * @brief checkLockFigure для фигуры, лежащей на заполненной части поля.
+ *
+ * Каждая итерация начинается с копии подготовленной игры: закрепление
+ * меняет поле и создает следующую фигуру. Копия входит в измеренное
+ * время.
+ */
+static void BM_CheckLockFigure(benchmark::State &state) {
+  Tetris base;
+  PrepareGame(&base, static_cast<int>(state.range(0)), 0);
+  while (isValidPosition(&base, 0, 1)) base.figure.y++;
+  Tetris game = base;
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) {
+    game = base;
+    checkLockFigure(&game);
+    benchmark::DoNotOptimize(game.board.rows);
+  }
+  ReportAllocs(state, allocs);
+  freeSpace(&base);
+}
+BENCHMARK(BM_CheckLockFigure)->ArgName("filled")->DenseRange(0, 15, 5);
+
+/**
+ * @brief attachingFigures: удаление fullRows заполненных строк и сдвиг
+ * остальных.
+ *
+ * Каждая итерация восстанавливает подготовленное поле (входит в измеренное
+ * время).
+ */
+static void BM_AttachingFigures(benchmark::State &state) {
+  Tetris game;
+  PrepareGame(&game, static_cast<int>(state.range(0)),
+              static_cast<int>(state.range(1)));
+  Board_t board = game.board;
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) {
+    game.board = board;
+    benchmark::DoNotOptimize(attachingFigures(&game));
+  }
+  ReportAllocs(state, allocs);
+  freeSpace(&game);
+}
+BENCHMARK(BM_AttachingFigures)
+    ->ArgNames({"filled", "full"})
+    ->ArgsProduct({{4, 10, 15}, {0, 1, 4}});
+
+/**
+ * @brief initializeFigure: проверка строк и выбор следующей фигуры.
+ *
+ * Каждая итерация восстанавливает подготовленное поле (входит в измеренное
+ * время).
+ */
+static void BM_InitializeFigure(benchmark::State &state) {
+  Tetris game;
+  PrepareGame(&game, static_cast<int>(state.range(0)), 0);
+  Board_t board = game.board;
+  uint64_t allocs = AllocCount();
+  for (auto _ : state) {
+    game.board = board;
+    initializeFigure(&game);
+    benchmark::DoNotOptimize(game.figure);
+  }
+  ReportAllocs(state, allocs);
+  freeSpace(&game);
+}
+BENCHMARK(BM_InitializeFigure)->ArgName("filled")->DenseRange(0, 15, 5);
+
+}  // namespace bench
+}  // namespace s21
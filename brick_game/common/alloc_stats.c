@@ -0,0 +1,146 @@
+#include "alloc_stats.h"
+
+#include <errno.h>
+#include <malloc.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/// Выделения по фазам с начала работы программы.
+static AllocStats_t allocTotals;
+/// Активная фаза потока.
+static __thread AllocPhase_t allocPhase = ALLOC_IDLE;
+
+#ifdef ALLOC_STATS
+#ifdef __cplusplus
+extern "C" {
+#endif
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @brief Учитывает выделение в активной фазе потока.
+ *
+ * @param size Запрошено байт.
+ */
+static void allocCount(size_t size) {
+  __atomic_fetch_add(&allocTotals.count[allocPhase], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&allocTotals.bytes[allocPhase], size, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size) {
+  allocCount(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  allocCount(count * size);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  allocCount(size);
+  return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+  allocCount(size);
+  return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  allocCount(size);
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+  int error = EINVAL;
+  if (alignment % sizeof(void *) == 0 && (alignment & (alignment - 1)) == 0) {
+    allocCount(size);
+    void *block = __libc_memalign(alignment, size);
+    error = block ? 0 : ENOMEM;
+    if (block) *ptr = block;
+  }
+  return error;
+}
+#endif
+
+/**
+ * @brief Подсчитываются ли выделения в этой сборке.
+ *
+ * @return true Сборка с ALLOC_STATS.
+ */
+bool allocStatsEnabled(void) {
+#ifdef ALLOC_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Делает phase активной фазой вызывающего потока.
+ *
+ * @param phase Новая фаза.
+ * @return AllocPhase_t Прежняя фаза (для allocPhaseRestore).
+ */
+AllocPhase_t allocPhaseEnter(AllocPhase_t phase) {
+  AllocPhase_t previous = allocPhase;
+  allocPhase = phase;
+  return previous;
+}
+
+/**
+ * @brief Возвращает фазу, активную до allocPhaseEnter.
+ *
+ * Принимает указатель, чтобы вызываться при выходе из блока
+ * (__attribute__((cleanup)) в ALLOC_PHASE).
+ *
+ * @param previous Фаза, которую вернул allocPhaseEnter.
+ */
+void allocPhaseRestore(const AllocPhase_t *previous) { allocPhase = *previous; }
+
+/**
+ * @brief Активная фаза вызывающего потока.
+ *
+ * @return AllocPhase_t Фаза.
+ */
+AllocPhase_t allocPhaseCurrent(void) { return allocPhase; }
+
+/**
+ * @brief Снимок счетчиков выделений всех потоков.
+ *
+ * @param stats Куда записать счетчики.
+ */
+void allocStatsTake(AllocStats_t *stats) {
+  for (int k = 0; k < ALLOC_PHASES; k++) {
+    stats->count[k] = __atomic_load_n(&allocTotals.count[k], __ATOMIC_RELAXED);
+    stats->bytes[k] = __atomic_load_n(&allocTotals.bytes[k], __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * @brief Количество выделений после снимка.
+ *
+ * Помощник для тестов: снимок перед проверяемым кодом, затем проверка, что
+ * allocStatsSince вернул 0.
+ *
+ * @param before Снимок allocStatsTake.
+ * @param phase Фаза или ALLOC_PHASES - все фазы.
+ * @return uint64_t Количество выделений.
+ */
+uint64_t allocStatsSince(const AllocStats_t *before, AllocPhase_t phase) {
+  AllocStats_t now;
+  allocStatsTake(&now);
+  uint64_t count = 0;
+  for (int k = 0; k < ALLOC_PHASES; k++) {
+    if (phase == ALLOC_PHASES || (int)phase == k) {
+      count += now.count[k] - before->count[k];
+    }
+  }
+  return count;
+}
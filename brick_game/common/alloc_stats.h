@@ -0,0 +1,72 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_ALLOC_STATS_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_ALLOC_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonAllocStats Allocation Stats
+ * Подсчет выделений памяти по фазам игры.
+ *
+ * В сборке с ALLOC_STATS (make ALLOC_STATS=1 ...) модуль подменяет malloc,
+ * calloc, realloc, aligned_alloc, posix_memalign и memalign и относит
+ * каждое выделение к фазе, которая активна в вызвавшем потоке. operator
+ * new из libstdc++ (в том числе с выравниванием) выделяет память через
+ * malloc и aligned_alloc, поэтому выделения C++ тоже учитываются. Фаза задается макросом
+ * ALLOC_PHASE в начале функции и действует до выхода из нее; вложенная
+ * фаза (например, появление фигуры внутри такта) после выхода возвращает
+ * прежнюю.
+ *
+ * Без ALLOC_STATS макрос ALLOC_PHASE пуст, функции выделения не
+ * подменяются, а счетчики всегда нулевые.
+ * @{
+ */
+
+/**
+ * @brief Фаза игры, к которой относится выделение памяти.
+ */
+typedef enum {
+  ALLOC_IDLE,    ///< Вне отмеченных фаз.
+  ALLOC_TICK,    ///< Такт игры: гравитация, шаг змейки.
+  ALLOC_INPUT,   ///< Обработка ввода.
+  ALLOC_SPAWN,   ///< Появление фигуры или яблока.
+  ALLOC_RENDER,  ///< Подготовка и отрисовка кадра.
+  ALLOC_PHASES   ///< Количество фаз; в allocStatsSince - все фазы.
+} AllocPhase_t;
+
+/**
+ * @brief Счетчики выделений по фазам.
+ */
+typedef struct {
+  uint64_t count[ALLOC_PHASES];  ///< Количество выделений.
+  uint64_t bytes[ALLOC_PHASES];  ///< Запрошено байт.
+} AllocStats_t;
+
+#ifdef ALLOC_STATS
+/// Делает phase активной фазой потока до конца текущего блока.
+#define ALLOC_PHASE(phase)                                     \
+  AllocPhase_t allocPhasePrevious_                             \
+      __attribute__((cleanup(allocPhaseRestore))) =            \
+          allocPhaseEnter(phase)
+#else
+#define ALLOC_PHASE(phase) ((void)0)
+#endif
+
+bool allocStatsEnabled(void);
+AllocPhase_t allocPhaseEnter(AllocPhase_t phase);
+void allocPhaseRestore(const AllocPhase_t *previous);
+AllocPhase_t allocPhaseCurrent(void);
+void allocStatsTake(AllocStats_t *stats);
+uint64_t allocStatsSince(const AllocStats_t *before, AllocPhase_t phase);
+
+/** @} */  // CommonAllocStats
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_ALLOC_STATS_H_
@@ -0,0 +1,64 @@
+#include "field.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Округляет размер вверх до кратного FIELD_ALIGNMENT.
+ */
+static size_t alignSize(size_t size) {
+  return (size + FIELD_ALIGNMENT - 1) / FIELD_ALIGNMENT * FIELD_ALIGNMENT;
+}
+
+/**
+ * @brief Создает поле одним выровненным выделением памяти.
+ *
+ * @param field Указатель на поле.
+ * @param height Количество строк.
+ * @param width Количество столбцов.
+ * @return true Если поле создано.
+ * @return false При ошибке выделения памяти или некорректном размере.
+ */
+bool fieldCreate(Field_t *field, int height, int width) {
+  memset(field, 0, sizeof(*field));
+  bool created = height > 0 && width > 0;
+  if (created) {
+    size_t cellsSize = alignSize(sizeof(int) * (size_t)height * width);
+    size_t size = alignSize(cellsSize + sizeof(int *) * (size_t)height);
+    unsigned char *block =
+        (unsigned char *)aligned_alloc(FIELD_ALIGNMENT, size);
+    created = block != NULL;
+    if (created) {
+      field->cells = (int *)block;
+      field->rows = (int **)(block + cellsSize);
+      field->height = height;
+      field->width = width;
+      for (int i = 0; i < height; i++) {
+        field->rows[i] = field->cells + FIELD_INDEX(field, i, 0);
+      }
+      fieldFill(field, 0);
+    }
+  }
+  return created;
+}
+
+/**
+ * @brief Освобождает память поля.
+ *
+ * @param field Указатель на поле.
+ */
+void fieldDestroy(Field_t *field) {
+  free(field->cells);
+  memset(field, 0, sizeof(*field));
+}
+
+/**
+ * @brief Заполняет все клетки поля значением.
+ *
+ * @param field Указатель на поле.
+ * @param value Значение клеток.
+ */
+void fieldFill(Field_t *field, int value) {
+  size_t count = (size_t)field->height * field->width;
+  for (size_t i = 0; i < count; i++) field->cells[i] = value;
+}
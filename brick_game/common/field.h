@@ -0,0 +1,47 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_FIELD_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_FIELD_H_
+#define FIELD_ALIGNMENT 64
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonField Game Field
+ * Общее для игр хранилище игрового поля.
+ * @{
+ */
+
+/**
+ * @brief Игровое поле в одном непрерывном блоке памяти.
+ *
+ * Клетки лежат подряд по строкам и выровнены по кэш-линии, сразу за ними в
+ * том же блоке хранится массив указателей на строки. Поле rows позволяет
+ * передавать поле фронтендам как int ** без дополнительных выделений.
+ */
+typedef struct {
+  int *cells;  ///< Клетки поля подряд по строкам (row-major).
+  int **rows;  ///< Представление int **: rows[i] = cells + i * width.
+  int height;  ///< Количество строк.
+  int width;   ///< Количество столбцов.
+} Field_t;
+
+bool fieldCreate(Field_t *field, int height, int width);
+void fieldDestroy(Field_t *field);
+void fieldFill(Field_t *field, int value);
+
+/**
+ * @brief Возвращает индекс клетки в непрерывном массиве cells.
+ */
+#define FIELD_INDEX(field, y, x) ((size_t)(y) * (size_t)(field)->width + (x))
+
+/** @} */  // CommonField
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_FIELD_H_
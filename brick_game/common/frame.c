@@ -0,0 +1,18 @@
+#include "frame.h"
+
+/**
+ * @brief Сравнивает значения панели двух кадров.
+ *
+ * @param before Значения предыдущего кадра.
+ * @param after Значения нового кадра.
+ * @return int Маска FRAME_* значений, которые различаются.
+ */
+int frameHudDiff(const FrameHud_t *before, const FrameHud_t *after) {
+  int hud = 0;
+  if (before->score != after->score) hud |= FRAME_SCORE;
+  if (before->high_score != after->high_score) hud |= FRAME_HIGH_SCORE;
+  if (before->level != after->level) hud |= FRAME_LEVEL;
+  if (before->next != after->next) hud |= FRAME_NEXT;
+  if (before->state != after->state) hud |= FRAME_STATE;
+  return hud;
+}
@@ -0,0 +1,56 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_FRAME_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_FRAME_H_
+#define FRAME_SCORE 1
+#define FRAME_HIGH_SCORE 2
+#define FRAME_LEVEL 4
+#define FRAME_NEXT 8
+#define FRAME_STATE 16
+#define FRAME_HUD_ITEMS 5
+#define FRAME_HUD_ALL ((1 << FRAME_HUD_ITEMS) - 1)
+#define FRAME_ROWS(height) ((uint32_t)((1ull << (height)) - 1))
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonFrame Frame Changes
+ * Описание изменений между кадрами для инкрементальной отрисовки.
+ *
+ * Бэкенды отмечают строки поля, которые изменились с предыдущего кадра, и
+ * значения панели (FRAME_*), отличающиеся от показанных. Фронтенд
+ * перерисовывает только их; смена статуса игры (FRAME_STATE) требует
+ * полной перерисовки, потому что меняет надписи поверх поля.
+ * @{
+ */
+
+/**
+ * @brief Изменения с предыдущего кадра.
+ */
+typedef struct {
+  uint32_t rows;  ///< Бит i - строка поля i изменилась.
+  int hud;        ///< Маска изменившихся значений панели FRAME_*.
+} FrameDiff_t;
+
+/**
+ * @brief Значения панели, показанные в кадре.
+ */
+typedef struct {
+  int score;       ///< Счет.
+  int high_score;  ///< Рекорд.
+  int level;       ///< Уровень.
+  int next;        ///< Следующая фигура (индекс или 0, если ее нет).
+  int state;       ///< Статус игры (pause).
+} FrameHud_t;
+
+int frameHudDiff(const FrameHud_t *before, const FrameHud_t *after);
+
+/** @} */  // CommonFrame
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_FRAME_H_
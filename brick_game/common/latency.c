@@ -0,0 +1,255 @@
+#include "latency.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Ячейка гистограммы для значения.
+ *
+ * @param ns Значение (не меньше 0).
+ * @return int Индекс ячейки.
+ */
+static int latencyBucket(uint64_t ns) {
+  int bucket = (int)ns;
+  if (ns >= LATENCY_SUB_BUCKETS) {
+    int shift = 63 - __builtin_clzll(ns) - LATENCY_SUB_BITS;
+    bucket = (shift + 1) * LATENCY_SUB_BUCKETS +
+             (int)(ns >> shift) - LATENCY_SUB_BUCKETS;
+  }
+  return bucket;
+}
+
+/**
+ * @brief Наибольшее значение, попадающее в ячейку.
+ *
+ * @param bucket Индекс ячейки.
+ * @return int64_t Верхняя граница ячейки.
+ */
+static int64_t latencyBucketTop(int bucket) {
+  int64_t top = bucket;
+  if (bucket >= LATENCY_SUB_BUCKETS) {
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    int64_t sub = LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS;
+    top = ((sub + 1) << shift) - 1;
+  }
+  return top;
+}
+
+/**
+ * @brief Создает пустую гистограмму.
+ *
+ * @param histogram Указатель на гистограмму.
+ */
+void latencyInit(LatencyHistogram_t *histogram) {
+  memset(histogram, 0, sizeof(*histogram));
+}
+
+/**
+ * @brief Добавляет значение в гистограмму.
+ *
+ * Можно вызывать одновременно с чтением из другого потока.
+ *
+ * @param histogram Указатель на гистограмму.
+ * @param ns Задержка в наносекундах (отрицательные считаются нулем).
+ */
+void latencyRecord(LatencyHistogram_t *histogram, int64_t ns) {
+  if (ns < 0) ns = 0;
+  __atomic_fetch_add(&histogram->counts[latencyBucket((uint64_t)ns)], 1,
+                     __ATOMIC_RELAXED);
+  __atomic_fetch_add(&histogram->total, 1, __ATOMIC_RELAXED);
+  int64_t max = __atomic_load_n(&histogram->maxNs, __ATOMIC_RELAXED);
+  while (ns > max &&
+         !__atomic_compare_exchange_n(&histogram->maxNs, &max, ns, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+/**
+ * @brief Количество значений в гистограмме.
+ *
+ * @param histogram Указатель на гистограмму.
+ * @return uint64_t Количество значений.
+ */
+uint64_t latencyCount(const LatencyHistogram_t *histogram) {
+  return __atomic_load_n(&histogram->total, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Наибольшее значение в гистограмме.
+ *
+ * @param histogram Указатель на гистограмму.
+ * @return int64_t Наибольшее значение (0 - гистограмма пуста).
+ */
+int64_t latencyMax(const LatencyHistogram_t *histogram) {
+  return __atomic_load_n(&histogram->maxNs, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Перцентиль гистограммы.
+ *
+ * Возвращается верхняя граница ячейки, в которую попал перцентиль, но не
+ * больше наибольшего значения: результат не меньше точного перцентиля и
+ * отличается от него не больше чем на 1/LATENCY_SUB_BUCKETS.
+ *
+ * @param histogram Указатель на гистограмму.
+ * @param percentile Перцентиль от 0 до 100.
+ * @return int64_t Значение перцентиля (0 - гистограмма пуста).
+ */
+int64_t latencyPercentile(const LatencyHistogram_t *histogram,
+                          double percentile) {
+  uint64_t total = latencyCount(histogram);
+  int64_t max = latencyMax(histogram);
+  uint64_t target = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+  if (target < 1) target = 1;
+  int64_t value = total ? max : 0;
+  uint64_t seen = 0;
+  for (int k = 0; k < LATENCY_BUCKETS && total && seen < target; k++) {
+    seen += __atomic_load_n(&histogram->counts[k], __ATOMIC_RELAXED);
+    if (seen >= target && latencyBucketTop(k) < max) {
+      value = latencyBucketTop(k);
+    }
+  }
+  return value;
+}
+
+/**
+ * @brief Создает пустые гистограммы игры, оверлей выключен.
+ *
+ * @param stats Указатель на задержки игры.
+ */
+void latencyStatsInit(LatencyStats_t *stats) {
+  latencyInit(&stats->tick);
+  latencyInit(&stats->paint);
+  latencyInit(&stats->input);
+  stats->keyNs = 0;
+  stats->overlay = false;
+}
+
+/**
+ * @brief Отмечает нажатие клавиши.
+ *
+ * Если предыдущее нажатие еще не обработано, отсчет идет от него: задержка
+ * считается от первого нажатия, которое ждет игру.
+ *
+ * @param stats Указатель на задержки игры.
+ * @param nowNs Время нажатия (tickNow).
+ */
+void latencyKeyPressed(LatencyStats_t *stats, int64_t nowNs) {
+  int64_t none = 0;
+  __atomic_compare_exchange_n(&stats->keyNs, &none, nowNs, false,
+                              __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Отмечает, что игра обработала нажатия, и записывает задержку.
+ *
+ * Без отмеченного нажатия ничего не записывается.
+ *
+ * @param stats Указатель на задержки игры.
+ * @param nowNs Время после обработки (tickNow).
+ */
+void latencyKeyApplied(LatencyStats_t *stats, int64_t nowNs) {
+  int64_t keyNs = __atomic_exchange_n(&stats->keyNs, 0, __ATOMIC_RELAXED);
+  if (keyNs) latencyRecord(&stats->input, nowNs - keyNs);
+}
+
+/**
+ * @brief Записывает задержку не длиннее 4 символов с единицей измерения.
+ *
+ * Единицы: n - наносекунды, u - микросекунды, m - миллисекунды, s -
+ * секунды. Значения меньше 10 выводятся с одним знаком после точки:
+ * "950n", "1.2u", "45m".
+ *
+ * @param ns Задержка в наносекундах.
+ * @param buffer Буфер строки.
+ * @param size Размер буфера.
+ */
+void latencyFormatNs(int64_t ns, char *buffer, size_t size) {
+  static const char units[] = "num";
+  int64_t scale = 1;
+  int unit = 0;
+  while (unit < 3 && ns >= scale * 1000) {
+    scale *= 1000;
+    unit++;
+  }
+  char suffix = unit < 3 ? units[unit] : 's';
+  int64_t tenths = ns * 10 / scale;
+  if (unit > 0 && tenths < 100) {
+    snprintf(buffer, size, "%d.%d%c", (int)(tenths / 10), (int)(tenths % 10),
+             suffix);
+  } else {
+    snprintf(buffer, size, "%lld%c", (long long)(ns / scale), suffix);
+  }
+}
+
+/**
+ * @brief Строка оверлея: метка, p50, p99 и максимум.
+ *
+ * Например "T 950n/1.2u/12u"; для пустой гистограммы - "T -".
+ *
+ * @param histogram Указатель на гистограмму.
+ * @param label Метка гистограммы.
+ * @param buffer Буфер строки.
+ * @param size Размер буфера.
+ */
+void latencySummary(const LatencyHistogram_t *histogram, char label,
+                    char *buffer, size_t size) {
+  if (latencyCount(histogram)) {
+    char p50[8], p99[8], max[8];
+    latencyFormatNs(latencyPercentile(histogram, 50), p50, sizeof(p50));
+    latencyFormatNs(latencyPercentile(histogram, 99), p99, sizeof(p99));
+    latencyFormatNs(latencyMax(histogram), max, sizeof(max));
+    snprintf(buffer, size, "%c %s/%s/%s", label, p50, p99, max);
+  } else {
+    snprintf(buffer, size, "%c -", label);
+  }
+}
+
+/**
+ * @brief Дописывает перцентили гистограммы в файл.
+ *
+ * @param file Файл.
+ * @param game Название игры.
+ * @param name Название гистограммы.
+ * @param histogram Указатель на гистограмму.
+ */
+static void latencyDumpHistogram(FILE *file, const char *game,
+                                 const char *name,
+                                 const LatencyHistogram_t *histogram) {
+  fprintf(file,
+          "%s %s count %llu p50 %lld p90 %lld p99 %lld p99.9 %lld max %lld "
+          "ns\n",
+          game, name, (unsigned long long)latencyCount(histogram),
+          (long long)latencyPercentile(histogram, 50),
+          (long long)latencyPercentile(histogram, 90),
+          (long long)latencyPercentile(histogram, 99),
+          (long long)latencyPercentile(histogram, 99.9),
+          (long long)latencyMax(histogram));
+}
+
+/**
+ * @brief Дописывает гистограммы игры в файл при выходе.
+ *
+ * По строке на гистограмму: количество значений, p50, p90, p99, p99.9 и
+ * максимум в наносекундах. Игра без тактов не записывается.
+ *
+ * @param stats Указатель на задержки игры.
+ * @param game Название игры.
+ * @param path Путь к файлу (LATENCY_FILE).
+ * @return true Гистограммы записаны или записывать нечего.
+ */
+bool latencyDump(const LatencyStats_t *stats, const char *game,
+                 const char *path) {
+  bool written = true;
+  if (latencyCount(&stats->tick)) {
+    FILE *file = fopen(path, "a");
+    written = file != NULL;
+    if (written) {
+      latencyDumpHistogram(file, game, "tick", &stats->tick);
+      latencyDumpHistogram(file, game, "paint", &stats->paint);
+      latencyDumpHistogram(file, game, "input", &stats->input);
+      written = fclose(file) == 0;
+    }
+  }
+  return written;
+}
@@ -0,0 +1,74 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_LATENCY_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_LATENCY_H_
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS) * LATENCY_SUB_BUCKETS)
+#define LATENCY_FILE "latency.log"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonLatency Latency Histograms
+ * Гистограммы задержек игрового цикла: длительность такта, длительность
+ * отрисовки и задержка от нажатия клавиши до изменения состояния игры.
+ *
+ * Гистограмма устроена как HDR Histogram: значения до LATENCY_SUB_BUCKETS
+ * наносекунд хранятся точно, более крупные - в логарифмических диапазонах,
+ * каждый из которых поделен на LATENCY_SUB_BUCKETS равных частей.
+ * Относительная погрешность перцентилей не больше 1/LATENCY_SUB_BUCKETS
+ * при любом масштабе. Запись - несколько атомарных сложений без
+ * блокировок, поэтому поток игры пишет такты, а поток отрисовки в это
+ * время читает перцентили для оверлея.
+ * @{
+ */
+
+/**
+ * @brief Гистограмма задержек в наносекундах.
+ */
+typedef struct {
+  uint64_t counts[LATENCY_BUCKETS];  ///< Количество значений в ячейках.
+  uint64_t total;                    ///< Всего значений.
+  int64_t maxNs;                     ///< Наибольшее значение.
+} LatencyHistogram_t;
+
+/**
+ * @brief Задержки одной игры и состояние оверлея.
+ */
+typedef struct {
+  LatencyHistogram_t tick;   ///< Длительность такта игры.
+  LatencyHistogram_t paint;  ///< Длительность отрисовки кадра.
+  LatencyHistogram_t input;  ///< От нажатия клавиши до его обработки игрой.
+  int64_t keyNs;  ///< Время первого еще не обработанного нажатия (0 - нет).
+  bool overlay;   ///< Оверлей с перцентилями включен.
+} LatencyStats_t;
+
+void latencyInit(LatencyHistogram_t *histogram);
+void latencyRecord(LatencyHistogram_t *histogram, int64_t ns);
+uint64_t latencyCount(const LatencyHistogram_t *histogram);
+int64_t latencyMax(const LatencyHistogram_t *histogram);
+int64_t latencyPercentile(const LatencyHistogram_t *histogram,
+                          double percentile);
+
+void latencyStatsInit(LatencyStats_t *stats);
+void latencyKeyPressed(LatencyStats_t *stats, int64_t nowNs);
+void latencyKeyApplied(LatencyStats_t *stats, int64_t nowNs);
+
+void latencyFormatNs(int64_t ns, char *buffer, size_t size);
+void latencySummary(const LatencyHistogram_t *histogram, char label,
+                    char *buffer, size_t size);
+bool latencyDump(const LatencyStats_t *stats, const char *game,
+                 const char *path);
+
+/** @} */  // CommonLatency
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_LATENCY_H_
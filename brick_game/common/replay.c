@@ -0,0 +1,224 @@
+#include "replay.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Записывает число в буфер в порядке little-endian.
+ */
+static void putLE(uint8_t *out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) out[i] = (uint8_t)(value >> (8 * i));
+}
+
+/**
+ * @brief Читает число из буфера в порядке little-endian.
+ */
+static uint64_t getLE(const uint8_t *in, int bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; i++) value |= (uint64_t)in[i] << (8 * i);
+  return value;
+}
+
+/**
+ * @brief Начинает пустую запись партии.
+ *
+ * Память под события выделяется при первом событии.
+ *
+ * @param replay Указатель на запись.
+ * @param game Игра: REPLAY_TETRIS или REPLAY_SNAKE.
+ * @param seed Зерно генератора партии.
+ */
+void replayInit(Replay_t *replay, uint8_t game, uint64_t seed) {
+  memset(replay, 0, sizeof(*replay));
+  replay->game = game;
+  replay->seed = seed;
+}
+
+/**
+ * @brief Освобождает память записи.
+ *
+ * @param replay Указатель на запись.
+ */
+void replayFree(Replay_t *replay) {
+  free(replay->data);
+  memset(replay, 0, sizeof(*replay));
+}
+
+/**
+ * @brief Отмечает один такт гравитации.
+ *
+ * @param replay Указатель на запись.
+ */
+void replayTick(Replay_t *replay) { replay->ticks++; }
+
+/**
+ * @brief Добавляет вызов userInput в запись.
+ *
+ * @param replay Указатель на запись.
+ * @param action Действие пользователя (0-7).
+ * @param hold Удержание клавиши.
+ */
+void replayInput(Replay_t *replay, int action, bool hold) {
+  if (replay->capacity - replay->size < 10 && !replay->failed) {
+    size_t capacity = replay->capacity ? replay->capacity * 2 : 256;
+    uint8_t *data = (uint8_t *)realloc(replay->data, capacity);
+    if (data) {
+      replay->data = data;
+      replay->capacity = capacity;
+    } else {
+      replay->failed = true;
+    }
+  }
+  if (!replay->failed) {
+    uint64_t value = (replay->ticks - replay->lastTick) << 4 |
+                     (uint64_t)hold << 3 | (uint64_t)(action & 7);
+    while (value >= 0x80) {
+      replay->data[replay->size++] = (uint8_t)(value | 0x80);
+      value >>= 7;
+    }
+    replay->data[replay->size++] = (uint8_t)value;
+    replay->lastTick = replay->ticks;
+    replay->events++;
+  }
+}
+
+/**
+ * @brief Записывает заголовок и события в файл, открытый в режиме mode.
+ *
+ * @param replay Указатель на запись.
+ * @param path Путь к файлу.
+ * @param mode Режим fopen ("wb" или "wbx" - только новый файл).
+ * @return true Если файл записан полностью.
+ */
+static bool replayWrite(const Replay_t *replay, const char *path,
+                        const char *mode) {
+  uint8_t header[REPLAY_HEADER_SIZE] = {0};
+  memcpy(header, REPLAY_MAGIC, 4);
+  header[4] = REPLAY_VERSION;
+  header[5] = replay->game;
+  putLE(header + 8, replay->seed, 8);
+  putLE(header + 16, replay->ticks, 8);
+  putLE(header + 24, (uint32_t)replay->score, 4);
+  putLE(header + 28, replay->events, 4);
+  putLE(header + 32, replay->size, 4);
+  bool saved = !replay->failed;
+  FILE *file = saved ? fopen(path, mode) : NULL;
+  saved = file != NULL;
+  if (file) {
+    saved = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+            fwrite(replay->data, 1, replay->size, file) == replay->size;
+    saved = fclose(file) == 0 && saved;
+  }
+  return saved;
+}
+
+/**
+ * @brief Сохраняет запись в файл.
+ *
+ * @param replay Указатель на запись.
+ * @param path Путь к файлу.
+ * @return true Если файл записан полностью.
+ */
+bool replaySave(const Replay_t *replay, const char *path) {
+  return replayWrite(replay, path, "wb");
+}
+
+/**
+ * @brief Сохраняет запись законченной партии в каталог архива.
+ *
+ * Имя файла строится из игры и зерна: <dir>/tetris-<seed>.bgr или
+ * <dir>/snake-<seed>.bgr. Файл только создается, существующий архив не
+ * перезаписывается: если имя занято (партии с одинаковым зерном), к нему
+ * добавляется номер - <dir>/tetris-<seed>-1.bgr и так далее, до
+ * REPLAY_ARCHIVE_TRIES попыток. Каталог создается при необходимости.
+ *
+ * @param replay Указатель на запись.
+ * @param dir Каталог архива.
+ * @param score Итоговый счет партии для последующей проверки.
+ * @return true Если файл записан.
+ */
+bool replayArchive(Replay_t *replay, const char *dir, int score) {
+  char path[512];
+  replay->score = score;
+  bool saved = mkdir(dir, 0755) == 0 || errno == EEXIST;
+  bool taken = saved;
+  for (int copy = 0; taken && copy < REPLAY_ARCHIVE_TRIES; copy++) {
+    const char *game = replay->game == REPLAY_TETRIS ? "tetris" : "snake";
+    unsigned long long seed = (unsigned long long)replay->seed;
+    int length = copy ? snprintf(path, sizeof(path), "%s/%s-%llu-%d.bgr",
+                                 dir, game, seed, copy)
+                      : snprintf(path, sizeof(path), "%s/%s-%llu.bgr", dir,
+                                 game, seed);
+    errno = 0;
+    saved = length > 0 && (size_t)length < sizeof(path) &&
+            replayWrite(replay, path, "wbx");
+    taken = !saved && errno == EEXIST;
+  }
+  return saved;
+}
+
+/**
+ * @brief Загружает запись из файла.
+ *
+ * @param replay Указатель на запись, заполняется при успехе.
+ * @param path Путь к файлу.
+ * @return true Если файл прочитан и заголовок корректен.
+ */
+bool replayLoad(Replay_t *replay, const char *path) {
+  uint8_t header[REPLAY_HEADER_SIZE];
+  replayInit(replay, 0, 0);
+  FILE *file = fopen(path, "rb");
+  bool loaded = file && fread(header, 1, sizeof(header), file) ==
+                            sizeof(header) &&
+                !memcmp(header, REPLAY_MAGIC, 4) &&
+                header[4] == REPLAY_VERSION;
+  if (loaded) {
+    replay->game = header[5];
+    replay->seed = getLE(header + 8, 8);
+    replay->ticks = getLE(header + 16, 8);
+    replay->score = (int32_t)(uint32_t)getLE(header + 24, 4);
+    replay->events = (uint32_t)getLE(header + 28, 4);
+    replay->size = (size_t)getLE(header + 32, 4);
+    replay->capacity = replay->size;
+    replay->data = (uint8_t *)malloc(replay->size ? replay->size : 1);
+    loaded = replay->data &&
+             fread(replay->data, 1, replay->size, file) == replay->size;
+  }
+  if (file) fclose(file);
+  if (!loaded) replayFree(replay);
+  return loaded;
+}
+
+/**
+ * @brief Читает следующее событие записи.
+ *
+ * @param replay Указатель на запись.
+ * @param cursor Позиция чтения, в начале заполняется нулями.
+ * @param event Прочитанное событие.
+ * @return true Если событие прочитано; false в конце записи или при
+ * поврежденных данных (тогда cursor->offset < replay->size).
+ */
+bool replayNext(const Replay_t *replay, ReplayCursor_t *cursor,
+                ReplayEvent_t *event) {
+  uint64_t value = 0;
+  size_t offset = cursor->offset;
+  bool done = false;
+  for (int shift = 0; shift < 64 && offset < replay->size && !done;
+       shift += 7) {
+    uint8_t byte = replay->data[offset++];
+    value |= (uint64_t)(byte & 0x7F) << shift;
+    done = !(byte & 0x80);
+  }
+  if (done) {
+    cursor->offset = offset;
+    cursor->tick += value >> 4;
+    cursor->events++;
+    event->tick = cursor->tick;
+    event->hold = (value >> 3) & 1;
+    event->action = (int)(value & 7);
+  }
+  return done;
+}
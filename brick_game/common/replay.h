@@ -0,0 +1,83 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_REPLAY_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_REPLAY_H_
+#define REPLAY_MAGIC "BGRP"
+#define REPLAY_VERSION 1
+#define REPLAY_HEADER_SIZE 36
+#define REPLAY_TETRIS 1
+#define REPLAY_SNAKE 2
+#define REPLAY_DIR "replays"
+#define REPLAY_ARCHIVE_TRIES 1000
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonReplay Game Replay
+ * Компактная запись ввода и тактов игры для повторного воспроизведения.
+ *
+ * Файл состоит из заголовка REPLAY_HEADER_SIZE байт (магия, версия, игра,
+ * зерно генератора, число тактов, счет, число событий и размер данных, все
+ * числа little-endian) и потока событий. Событие - вызов userInput,
+ * закодированный одним varint: (тактов с прошлого события << 4) |
+ * (hold << 3) | action. Такты гравитации между событиями отдельно не
+ * хранятся, хвост после последнего события восстанавливается по общему
+ * числу тактов.
+ * @{
+ */
+
+/**
+ * @brief Запись партии: заголовок и закодированные события.
+ */
+typedef struct {
+  uint8_t *data;      ///< Закодированные события.
+  size_t size;        ///< Занятый размер data.
+  size_t capacity;    ///< Выделенный размер data.
+  uint64_t seed;      ///< Зерно генератора партии.
+  uint64_t ticks;     ///< Всего тактов гравитации.
+  uint64_t lastTick;  ///< Такт последнего события.
+  uint32_t events;    ///< Количество событий.
+  int32_t score;      ///< Итоговый счет партии.
+  uint8_t game;       ///< Игра: REPLAY_TETRIS или REPLAY_SNAKE.
+  bool failed;        ///< Не хватило памяти, запись неполная.
+} Replay_t;
+
+/**
+ * @brief Событие ввода, прочитанное из записи.
+ */
+typedef struct {
+  uint64_t tick;  ///< Количество тактов, выполненных до события.
+  int action;     ///< Действие пользователя.
+  bool hold;      ///< Удержание клавиши.
+} ReplayEvent_t;
+
+/**
+ * @brief Позиция чтения событий записи.
+ */
+typedef struct {
+  size_t offset;    ///< Смещение следующего события в data.
+  uint64_t tick;    ///< Такт последнего прочитанного события.
+  uint32_t events;  ///< Прочитано событий.
+} ReplayCursor_t;
+
+void replayInit(Replay_t *replay, uint8_t game, uint64_t seed);
+void replayFree(Replay_t *replay);
+void replayTick(Replay_t *replay);
+void replayInput(Replay_t *replay, int action, bool hold);
+bool replaySave(const Replay_t *replay, const char *path);
+bool replayArchive(Replay_t *replay, const char *dir, int score);
+bool replayLoad(Replay_t *replay, const char *path);
+bool replayNext(const Replay_t *replay, ReplayCursor_t *cursor,
+                ReplayEvent_t *event);
+
+/** @} */  // CommonReplay
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_REPLAY_H_
@@ -0,0 +1,201 @@
+#include "score_store.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static ScoreStore_t stores[SCORE_STORE_MAX];
+static int storeCount = 0;
+static pthread_mutex_t registry = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Записывает значение в файл через временный файл и rename.
+ *
+ * @param path Путь к файлу рекорда.
+ * @param value Рекорд.
+ */
+static void scoreStoreWrite(const char *path, int value) {
+  char temp[SCORE_STORE_PATH_MAX + 8];
+  snprintf(temp, sizeof(temp), "%s.tmp", path);
+  FILE *f = fopen(temp, "w");
+  if (f != NULL) {
+    bool written = fprintf(f, "%d", value) > 0 && fflush(f) == 0 &&
+                   fsync(fileno(f)) == 0;
+    written = fclose(f) == 0 && written;
+    if (!written || rename(temp, path) != 0) remove(temp);
+  }
+}
+
+/**
+ * @brief Поток записи: ждет новое значение, выжидает окно объединения и
+ * записывает последнее значение.
+ *
+ * @param arg Указатель на ScoreStore_t.
+ */
+static void *scoreStoreWorker(void *arg) {
+  ScoreStore_t *store = (ScoreStore_t *)arg;
+  pthread_mutex_lock(&store->mutex);
+  while (!store->stop || store->pending) {
+    if (!store->pending) {
+      pthread_cond_wait(&store->wake, &store->mutex);
+      continue;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += SCORE_STORE_COALESCE_MS * 1000000L;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+    deadline.tv_nsec %= 1000000000L;
+    int waited = 0;
+    while (!store->urgent && !store->stop && waited != ETIMEDOUT) {
+      waited = pthread_cond_timedwait(&store->wake, &store->mutex, &deadline);
+    }
+    int value = store->value;
+    store->pending = false;
+    store->urgent = false;
+    store->writing = true;
+    pthread_mutex_unlock(&store->mutex);
+    scoreStoreWrite(store->path, value);
+    pthread_mutex_lock(&store->mutex);
+    store->writing = false;
+    store->writes++;
+    pthread_cond_broadcast(&store->idle);
+  }
+  pthread_mutex_unlock(&store->mutex);
+  return NULL;
+}
+
+/**
+ * @brief Сбрасывает все хранилища и останавливает потоки записи.
+ *
+ * Регистрируется через atexit при открытии первого хранилища.
+ */
+static void scoreStoreShutdown(void) {
+  pthread_mutex_lock(&registry);
+  for (int i = 0; i < storeCount; i++) {
+    ScoreStore_t *store = &stores[i];
+    if (store->started) {
+      pthread_mutex_lock(&store->mutex);
+      store->stop = true;
+      pthread_cond_signal(&store->wake);
+      pthread_mutex_unlock(&store->mutex);
+      pthread_join(store->thread, NULL);
+      store->started = false;
+    }
+  }
+  pthread_mutex_unlock(&registry);
+}
+
+/**
+ * @brief Возвращает хранилище рекорда для файла, создавая его при первом
+ * обращении.
+ *
+ * Хранилища живут до конца процесса, на один путь приходится одно хранилище.
+ * Если поток записи не удалось запустить, запись выполняется синхронно.
+ *
+ * @param path Путь к файлу рекорда.
+ * @return ScoreStore_t* Хранилище или NULL, если путь слишком длинный или
+ * хранилищ больше SCORE_STORE_MAX.
+ */
+ScoreStore_t *scoreStoreOpen(const char *path) {
+  ScoreStore_t *found = NULL;
+  pthread_mutex_lock(&registry);
+  for (int i = 0; i < storeCount && !found; i++) {
+    if (!strcmp(stores[i].path, path)) found = &stores[i];
+  }
+  if (!found && storeCount < SCORE_STORE_MAX &&
+      strlen(path) < SCORE_STORE_PATH_MAX) {
+    if (storeCount == 0) atexit(scoreStoreShutdown);
+    found = &stores[storeCount++];
+    memset(found, 0, sizeof(*found));
+    strcpy(found->path, path);
+    pthread_mutex_init(&found->mutex, NULL);
+    pthread_cond_init(&found->wake, NULL);
+    pthread_cond_init(&found->idle, NULL);
+    found->started =
+        pthread_create(&found->thread, NULL, scoreStoreWorker, found) == 0;
+  }
+  pthread_mutex_unlock(&registry);
+  return found;
+}
+
+/**
+ * @brief Считывает рекорд из файла, предварительно дописав ожидающее
+ * значение.
+ *
+ * @param store Хранилище рекорда (NULL - рекорд 0).
+ * @return int Рекорд из файла или 0, если файла нет.
+ */
+int scoreStoreRead(ScoreStore_t *store) {
+  int value = 0;
+  if (store) {
+    scoreStoreFlush(store);
+    FILE *f = fopen(store->path, "r");
+    if (f != NULL) {
+      if (fscanf(f, "%d", &value) != 1) value = 0;
+      fclose(f);
+    }
+  }
+  return value;
+}
+
+/**
+ * @brief Запоминает новый рекорд и будит поток записи.
+ *
+ * Не обращается к файловой системе, если поток записи запущен. Значения,
+ * переданные в пределах окна объединения, записываются одной записью.
+ *
+ * @param store Хранилище рекорда (NULL - значение не сохраняется).
+ * @param value Рекорд.
+ */
+void scoreStoreSet(ScoreStore_t *store, int value) {
+  if (store) {
+    pthread_mutex_lock(&store->mutex);
+    store->value = value;
+    if (store->started) {
+      store->pending = true;
+      pthread_cond_signal(&store->wake);
+    } else {
+      scoreStoreWrite(store->path, value);
+      store->writes++;
+    }
+    pthread_mutex_unlock(&store->mutex);
+  }
+}
+
+/**
+ * @brief Дожидается записи последнего значения в файл.
+ *
+ * @param store Хранилище рекорда (NULL - ничего не делает).
+ */
+void scoreStoreFlush(ScoreStore_t *store) {
+  if (store) {
+    pthread_mutex_lock(&store->mutex);
+    if (store->pending) {
+      store->urgent = true;
+      pthread_cond_signal(&store->wake);
+    }
+    while (store->pending || store->writing) {
+      pthread_cond_wait(&store->idle, &store->mutex);
+    }
+    pthread_mutex_unlock(&store->mutex);
+  }
+}
+
+/**
+ * @brief Возвращает количество выполненных записей файла.
+ *
+ * @param store Хранилище рекорда.
+ * @return uint64_t Количество записей (0 для NULL).
+ */
+uint64_t scoreStoreWrites(ScoreStore_t *store) {
+  uint64_t writes = 0;
+  if (store) {
+    pthread_mutex_lock(&store->mutex);
+    writes = store->writes;
+    pthread_mutex_unlock(&store->mutex);
+  }
+  return writes;
+}
@@ -0,0 +1,58 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_SCORE_STORE_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_SCORE_STORE_H_
+#define SCORE_STORE_MAX 4
+#define SCORE_STORE_PATH_MAX 256
+#define SCORE_STORE_COALESCE_MS 200
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonScoreStore High Score Store
+ * Хранение рекорда в памяти с сохранением в файл фоновым потоком.
+ *
+ * Игровой поток только запоминает новое значение и будит поток записи.
+ * Поток записи выжидает SCORE_STORE_COALESCE_MS, чтобы несколько рекордов
+ * подряд ушли на диск одной записью, и сохраняет последнее значение через
+ * временный файл и rename, так что файл рекорда никогда не бывает частично
+ * записан. scoreStoreFlush дожидается записи (конец игры), при выходе из
+ * процесса все хранилища сбрасываются автоматически.
+ * @{
+ */
+
+/**
+ * @brief Хранилище рекорда одного файла.
+ */
+typedef struct {
+  char path[SCORE_STORE_PATH_MAX];  ///< Путь к файлу рекорда.
+  int value;                        ///< Последнее переданное значение.
+  bool pending;                     ///< value еще не записано в файл.
+  bool writing;                     ///< Поток записи пишет файл.
+  bool urgent;                      ///< Записать без ожидания.
+  bool stop;                        ///< Поток записи должен завершиться.
+  bool started;                     ///< Поток записи запущен.
+  uint64_t writes;                  ///< Количество записей файла.
+  pthread_mutex_t mutex;            ///< Защищает поля хранилища.
+  pthread_cond_t wake;              ///< Будит поток записи.
+  pthread_cond_t idle;              ///< Сообщает о завершении записи.
+  pthread_t thread;                 ///< Поток записи.
+} ScoreStore_t;
+
+ScoreStore_t *scoreStoreOpen(const char *path);
+int scoreStoreRead(ScoreStore_t *store);
+void scoreStoreSet(ScoreStore_t *store, int value);
+void scoreStoreFlush(ScoreStore_t *store);
+uint64_t scoreStoreWrites(ScoreStore_t *store);
+
+/** @} */  // CommonScoreStore
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_SCORE_STORE_H_
@@ -0,0 +1,222 @@
+#include "sim_thread.h"
+
+#include <errno.h>
+#include <time.h>
+
+/**
+ * @brief Создает пустую очередь ввода.
+ *
+ * @param queue Указатель на очередь.
+ */
+void simQueueInit(SimQueue_t *queue) {
+  queue->head = 0;
+  queue->tail = 0;
+}
+
+/**
+ * @brief Добавляет событие в очередь (только поток-производитель).
+ *
+ * @param queue Указатель на очередь.
+ * @param action Действие пользователя.
+ * @param hold Удержание клавиши.
+ * @return true Событие добавлено, false - очередь заполнена.
+ */
+bool simQueuePush(SimQueue_t *queue, int action, bool hold) {
+  uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+  uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+  bool pushed = head - tail < SIM_QUEUE_SIZE;
+  if (pushed) {
+    SimInput_t *event = &queue->events[head % SIM_QUEUE_SIZE];
+    event->action = action;
+    event->hold = hold;
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+  }
+  return pushed;
+}
+
+/**
+ * @brief Забирает самое старое событие (только поток-потребитель).
+ *
+ * @param queue Указатель на очередь.
+ * @param input Куда записать событие.
+ * @return true Событие получено, false - очередь пуста.
+ */
+bool simQueuePop(SimQueue_t *queue, SimInput_t *input) {
+  uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+  uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+  bool popped = head != tail;
+  if (popped) {
+    *input = queue->events[tail % SIM_QUEUE_SIZE];
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+  }
+  return popped;
+}
+
+/**
+ * @brief Раздает слоты: 0 читателю, 1 в обмен, 2 писателю.
+ *
+ * @param frames Указатель на тройной буфер.
+ */
+void simFramesInit(SimFrames_t *frames) {
+  frames->front = 0;
+  frames->published = 0;
+  frames->shared = 1;
+  frames->back = 2;
+}
+
+/**
+ * @brief Публикует заполненный слот back и выдает писателю новый.
+ *
+ * Возвращает true, если читатель уже забрал предыдущий кадр: только тогда
+ * его нужно уведомить, иначе предыдущее уведомление еще не обработано и
+ * читатель заберет сразу новый кадр.
+ *
+ * @param frames Указатель на тройной буфер.
+ * @return true Читателя нужно уведомить о новом кадре.
+ */
+bool simFramesPublish(SimFrames_t *frames) {
+  frames->published = frames->back;
+  int previous = __atomic_exchange_n(
+      &frames->shared, frames->back | SIM_FRAME_FRESH, __ATOMIC_ACQ_REL);
+  frames->back = previous & SIM_FRAME_SLOT;
+  return !(previous & SIM_FRAME_FRESH);
+}
+
+/**
+ * @brief Забирает последний опубликованный кадр в слот front.
+ *
+ * @param frames Указатель на тройной буфер.
+ * @return true Слот front сменился на более новый кадр.
+ */
+bool simFramesAcquire(SimFrames_t *frames) {
+  bool fresh =
+      __atomic_load_n(&frames->shared, __ATOMIC_RELAXED) & SIM_FRAME_FRESH;
+  if (fresh) {
+    int previous = __atomic_exchange_n(&frames->shared, frames->front,
+                                       __ATOMIC_ACQ_REL);
+    frames->front = previous & SIM_FRAME_SLOT;
+  }
+  return fresh;
+}
+
+/**
+ * @brief Основной цикл потока игры: шаг, затем сон до срока следующего
+ * шага или до нового ввода.
+ *
+ * @param arg Указатель на SimThread_t.
+ */
+static void *simThreadMain(void *arg) {
+  SimThread_t *sim = (SimThread_t *)arg;
+  pthread_mutex_lock(&sim->mutex);
+  while (!sim->stop) {
+    sim->kicked = false;
+    pthread_mutex_unlock(&sim->mutex);
+    int64_t waitNs = sim->step(sim->context);
+    pthread_mutex_lock(&sim->mutex);
+    if (waitNs < 0) {
+      while (!sim->kicked && !sim->stop) {
+        pthread_cond_wait(&sim->wake, &sim->mutex);
+      }
+    } else {
+      struct timespec deadline;
+      clock_gettime(CLOCK_MONOTONIC, &deadline);
+      deadline.tv_sec += waitNs / 1000000000LL;
+      deadline.tv_nsec += waitNs % 1000000000LL;
+      deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+      deadline.tv_nsec %= 1000000000L;
+      int waited = 0;
+      while (!sim->kicked && !sim->stop && waited != ETIMEDOUT) {
+        waited = pthread_cond_timedwait(&sim->wake, &sim->mutex, &deadline);
+      }
+    }
+  }
+  pthread_mutex_unlock(&sim->mutex);
+  return NULL;
+}
+
+/**
+ * @brief Подготавливает поток игры, не запуская его.
+ *
+ * Очередь ввода доступна сразу: без потока события забирает сам шаг игры,
+ * вызванный фронтендом.
+ *
+ * @param sim Указатель на поток игры.
+ * @param step Шаг игры.
+ * @param context Аргумент шага.
+ */
+void simThreadInit(SimThread_t *sim, SimStep_t step, void *context) {
+  simQueueInit(&sim->input);
+  sim->step = step;
+  sim->context = context;
+  sim->started = false;
+  sim->stop = false;
+  sim->kicked = false;
+}
+
+/**
+ * @brief Запускает поток игры.
+ *
+ * Ожидание идет по CLOCK_MONOTONIC, как и планировщик тактов.
+ *
+ * @param sim Указатель на поток игры.
+ * @return true Поток запущен (или уже работал), false - шаги должен
+ * вызывать фронтенд.
+ */
+bool simThreadStart(SimThread_t *sim) {
+  if (!sim->started) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&sim->mutex, NULL);
+    pthread_cond_init(&sim->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    sim->stop = false;
+    sim->kicked = false;
+    sim->started = pthread_create(&sim->thread, NULL, simThreadMain, sim) == 0;
+    if (!sim->started) {
+      pthread_cond_destroy(&sim->wake);
+      pthread_mutex_destroy(&sim->mutex);
+    }
+  }
+  return sim->started;
+}
+
+/**
+ * @brief Передает ввод в поток игры и будит его.
+ *
+ * @param sim Указатель на поток игры.
+ * @param action Действие пользователя.
+ * @param hold Удержание клавиши.
+ * @return true Событие принято, false - очередь заполнена и событие
+ * отброшено.
+ */
+bool simThreadPost(SimThread_t *sim, int action, bool hold) {
+  bool queued = simQueuePush(&sim->input, action, hold);
+  if (queued && sim->started) {
+    pthread_mutex_lock(&sim->mutex);
+    sim->kicked = true;
+    pthread_cond_signal(&sim->wake);
+    pthread_mutex_unlock(&sim->mutex);
+  }
+  return queued;
+}
+
+/**
+ * @brief Останавливает поток игры и дожидается его завершения.
+ *
+ * Необработанный ввод остается в очереди.
+ *
+ * @param sim Указатель на поток игры.
+ */
+void simThreadStop(SimThread_t *sim) {
+  if (sim->started) {
+    pthread_mutex_lock(&sim->mutex);
+    sim->stop = true;
+    pthread_cond_signal(&sim->wake);
+    pthread_mutex_unlock(&sim->mutex);
+    pthread_join(sim->thread, NULL);
+    pthread_cond_destroy(&sim->wake);
+    pthread_mutex_destroy(&sim->mutex);
+    sim->started = false;
+  }
+}
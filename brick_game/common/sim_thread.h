@@ -0,0 +1,108 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_SIM_THREAD_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_SIM_THREAD_H_
+#define SIM_QUEUE_SIZE 64
+#define SIM_FRAMES 3
+#define SIM_FRAME_SLOT 3
+#define SIM_FRAME_FRESH 4
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonSimThread Simulation Thread
+ * Поток игровой логики, отделенный от потока отрисовки.
+ *
+ * Фронтенд передает ввод в поток игры через очередь одного производителя и
+ * одного потребителя (SimQueue_t), а поток игры отдает кадры через тройной
+ * буфер (SimFrames_t). Ни очередь, ни буфер не используют блокировок:
+ * отрисовка не ждет игру, а игра не ждет отрисовку. Мьютекс SimThread_t
+ * нужен только чтобы усыпить поток игры до следующего такта или ввода.
+ *
+ * Без запущенного потока та же очередь и те же кадры работают в одном
+ * потоке: фронтенд сам вызывает шаг игры по таймеру.
+ * @{
+ */
+
+/**
+ * @brief Событие ввода для потока игры.
+ */
+typedef struct {
+  int action;  ///< Действие пользователя (UserAction_t).
+  bool hold;   ///< Удержание клавиши.
+} SimInput_t;
+
+/**
+ * @brief Очередь ввода одного производителя и одного потребителя.
+ *
+ * head меняет только производитель, tail - только потребитель; индексы
+ * растут без ограничения, позиция в кольце - младшие биты.
+ */
+typedef struct {
+  SimInput_t events[SIM_QUEUE_SIZE];  ///< Кольцо событий.
+  uint32_t head;                      ///< Номер следующей записи.
+  uint32_t tail;                      ///< Номер следующего чтения.
+} SimQueue_t;
+
+/**
+ * @brief Тройной буфер кадров: индексы трех слотов, кадры хранит игра.
+ *
+ * Поток игры заполняет слот back и меняет его местами с shared, поток
+ * отрисовки забирает shared в front, если там есть новый кадр (флаг
+ * SIM_FRAME_FRESH). Слот front не меняется, пока его не отпустит читатель.
+ */
+typedef struct {
+  int back;       ///< Слот, который заполняет поток игры.
+  int published;  ///< Последний опубликованный слот (поток игры).
+  int shared;     ///< Слот обмена и флаг SIM_FRAME_FRESH (атомарно).
+  int front;      ///< Слот, который читает поток отрисовки.
+} SimFrames_t;
+
+/**
+ * @brief Шаг игры: обработать ввод из очереди, выполнить такты, опубликовать
+ * кадр.
+ *
+ * @return int64_t Наносекунды до следующего шага, отрицательное значение -
+ * ждать только ввода.
+ */
+typedef int64_t (*SimStep_t)(void *context);
+
+/**
+ * @brief Поток игры и его очередь ввода.
+ */
+typedef struct {
+  SimQueue_t input;       ///< Ввод от фронтенда.
+  SimStep_t step;         ///< Шаг игры.
+  void *context;          ///< Аргумент шага.
+  bool started;           ///< Поток запущен.
+  bool stop;              ///< Поток должен завершиться.
+  bool kicked;            ///< Появился ввод, шаг нужен без ожидания.
+  pthread_mutex_t mutex;  ///< Защищает stop и kicked.
+  pthread_cond_t wake;    ///< Будит поток игры.
+  pthread_t thread;       ///< Поток игры.
+} SimThread_t;
+
+void simQueueInit(SimQueue_t *queue);
+bool simQueuePush(SimQueue_t *queue, int action, bool hold);
+bool simQueuePop(SimQueue_t *queue, SimInput_t *input);
+
+void simFramesInit(SimFrames_t *frames);
+bool simFramesPublish(SimFrames_t *frames);
+bool simFramesAcquire(SimFrames_t *frames);
+
+void simThreadInit(SimThread_t *sim, SimStep_t step, void *context);
+bool simThreadStart(SimThread_t *sim);
+bool simThreadPost(SimThread_t *sim, int action, bool hold);
+void simThreadStop(SimThread_t *sim);
+
+/** @} */  // CommonSimThread
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_SIM_THREAD_H_
@@ -0,0 +1,105 @@
+#include "tick_scheduler.h"
+
+#include <time.h>
+
+/**
+ * @brief Текущее время монотонных часов.
+ *
+ * @return int64_t Время в наносекундах от произвольной точки отсчета.
+ */
+int64_t tickNow(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Инициализирует планировщик без накопленного времени.
+ *
+ * @param scheduler Указатель на планировщик.
+ * @param periodNs Длительность такта (не меньше TICK_MIN_PERIOD_NS).
+ * @param nowNs Текущее время (tickNow).
+ */
+void tickInit(TickScheduler_t *scheduler, int64_t periodNs, int64_t nowNs) {
+  scheduler->lastNs = nowNs;
+  scheduler->accumulatorNs = 0;
+  scheduler->maxSteps = TICK_MAX_STEPS;
+  scheduler->dropped = 0;
+  tickSetPeriod(scheduler, periodNs);
+}
+
+/**
+ * @brief Меняет длительность такта, сохраняя накопленное время.
+ *
+ * @param scheduler Указатель на планировщик.
+ * @param periodNs Длительность такта (не меньше TICK_MIN_PERIOD_NS).
+ */
+void tickSetPeriod(TickScheduler_t *scheduler, int64_t periodNs) {
+  scheduler->periodNs =
+      periodNs < TICK_MIN_PERIOD_NS ? TICK_MIN_PERIOD_NS : periodNs;
+}
+
+/**
+ * @brief Учитывает прошедшее время и возвращает число тактов к выполнению.
+ *
+ * @param scheduler Указатель на планировщик.
+ * @param nowNs Текущее время (tickNow).
+ * @return int Количество тактов, не больше maxSteps.
+ */
+int tickAdvance(TickScheduler_t *scheduler, int64_t nowNs) {
+  if (nowNs > scheduler->lastNs) {
+    scheduler->accumulatorNs += nowNs - scheduler->lastNs;
+    scheduler->lastNs = nowNs;
+  }
+  int64_t due = scheduler->accumulatorNs / scheduler->periodNs;
+  int steps = due > scheduler->maxSteps ? scheduler->maxSteps : (int)due;
+  if (due > steps) {
+    scheduler->dropped += (uint64_t)(due - steps);
+    scheduler->accumulatorNs %= scheduler->periodNs;
+  } else {
+    scheduler->accumulatorNs -= steps * scheduler->periodNs;
+  }
+  return steps;
+}
+
+/**
+ * @brief Пропускает прошедшее время без тактов (пауза, меню).
+ *
+ * Накопленная часть текущего такта сохраняется.
+ *
+ * @param scheduler Указатель на планировщик.
+ * @param nowNs Текущее время (tickNow).
+ */
+void tickSkip(TickScheduler_t *scheduler, int64_t nowNs) {
+  scheduler->lastNs = nowNs;
+}
+
+/**
+ * @brief Время до следующего такта.
+ *
+ * @param scheduler Указатель на планировщик.
+ * @param nowNs Текущее время (tickNow).
+ * @return int64_t Наносекунды до следующего такта, 0 если такт уже должен
+ * быть выполнен.
+ */
+int64_t tickUntilNext(const TickScheduler_t *scheduler, int64_t nowNs) {
+  int64_t elapsed = scheduler->accumulatorNs;
+  if (nowNs > scheduler->lastNs) elapsed += nowNs - scheduler->lastNs;
+  int64_t left = scheduler->periodNs - elapsed;
+  return left > 0 ? left : 0;
+}
+
+/**
+ * @brief Время до следующего такта в миллисекундах, округленное вверх.
+ *
+ * Подходит для таймаутов ожидания ввода (getch, QTimer): ожидание не
+ * заканчивается раньше такта.
+ *
+ * @param scheduler Указатель на планировщик.
+ * @param nowNs Текущее время (tickNow).
+ * @return int Миллисекунды до следующего такта.
+ */
+int tickUntilNextMs(const TickScheduler_t *scheduler, int64_t nowNs) {
+  int64_t left = tickUntilNext(scheduler, nowNs);
+  return (int)((left + TICK_NS_PER_MS - 1) / TICK_NS_PER_MS);
+}
@@ -0,0 +1,53 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_TICK_SCHEDULER_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_TICK_SCHEDULER_H_
+#define TICK_MAX_STEPS 5
+#define TICK_MIN_PERIOD_NS 1000000LL
+#define TICK_NS_PER_MS 1000000LL
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonTick Tick Scheduler
+ * Планировщик тактов с фиксированным шагом для игровых циклов.
+ *
+ * Время берется из CLOCK_MONOTONIC и накапливается между вызовами
+ * tickAdvance; каждый полный период дает один такт. Если цикл отстал
+ * (медленный кадр, загрузка системы), пропущенные такты выполняются
+ * подряд, но не больше maxSteps за вызов: остаток отбрасывается, чтобы
+ * игра не уходила в бесконечное догоняние. tickUntilNext сообщает, сколько
+ * ждать до следующего такта, поэтому скорость игры не зависит от частоты
+ * кадров.
+ * @{
+ */
+
+/**
+ * @brief Состояние планировщика тактов.
+ */
+typedef struct {
+  int64_t periodNs;       ///< Длительность такта в наносекундах.
+  int64_t lastNs;         ///< Момент, до которого учтено время.
+  int64_t accumulatorNs;  ///< Накопленное и не израсходованное время.
+  int maxSteps;           ///< Наибольшее число тактов за один вызов.
+  uint64_t dropped;       ///< Отброшено тактов из-за ограничения.
+} TickScheduler_t;
+
+int64_t tickNow(void);
+void tickInit(TickScheduler_t *scheduler, int64_t periodNs, int64_t nowNs);
+void tickSetPeriod(TickScheduler_t *scheduler, int64_t periodNs);
+int tickAdvance(TickScheduler_t *scheduler, int64_t nowNs);
+void tickSkip(TickScheduler_t *scheduler, int64_t nowNs);
+int64_t tickUntilNext(const TickScheduler_t *scheduler, int64_t nowNs);
+int tickUntilNextMs(const TickScheduler_t *scheduler, int64_t nowNs);
+
+/** @} */  // CommonTick
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_TICK_SCHEDULER_H_
@@ -0,0 +1,348 @@
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Закрытый интервал в кольцевом буфере.
+ */
+typedef struct {
+  const char *name;    ///< Имя интервала.
+  int64_t beginNs;     ///< Начало интервала.
+  int64_t durationNs;  ///< Длительность интервала.
+} TraceEvent_t;
+
+/**
+ * @brief Кольцевой буфер интервалов одного потока.
+ *
+ * Пишет только поток-владелец; head публикуется после записи события,
+ * поэтому traceFlush читает буфер без блокировок.
+ */
+typedef struct TraceRing {
+  TraceEvent_t events[TRACE_RING_EVENTS];  ///< События по кругу.
+  uint64_t head;                           ///< Записано событий всего.
+  int owned;                               ///< Буфер занят живым потоком.
+  int tid;                                 ///< Номер буфера (tid в файле).
+  struct TraceRing *next;                  ///< Следующий буфер списка.
+} TraceRing_t;
+
+/**
+ * @brief Буфер вывода traceFlush поверх write(2).
+ *
+ * Не использует stdio, поэтому traceFlush можно вызывать из обработчика
+ * сигнала.
+ */
+typedef struct {
+  int fd;           ///< Файл трассировки.
+  bool ok;          ///< Ошибок записи не было.
+  size_t length;    ///< Занято байт в data.
+  char data[4096];  ///< Еще не записанные байты.
+} TraceWriter_t;
+
+/// Буферы всех потоков, писавших интервалы.
+static TraceRing_t *traceRings;
+/// Выдано номеров буферов.
+static int traceRingCount;
+/// Буфер вызывающего потока.
+static __thread TraceRing_t *traceLocal;
+/// Ключ, деструктор которого освобождает буфер при завершении потока.
+static pthread_key_t traceKey;
+static pthread_once_t traceKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Текущее время CLOCK_MONOTONIC в наносекундах.
+ *
+ * @return int64_t Время.
+ */
+static int64_t traceNow(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief Отдает буфер завершившегося потока следующему потоку.
+ *
+ * @param ring Указатель на TraceRing_t.
+ */
+static void traceRelease(void *ring) {
+  __atomic_store_n(&((TraceRing_t *)ring)->owned, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Создает ключ освобождения буферов.
+ */
+static void traceKeyCreate(void) {
+  pthread_key_create(&traceKey, traceRelease);
+}
+
+/**
+ * @brief Занимает буфер для вызывающего потока.
+ *
+ * Сначала ищется буфер завершившегося потока, иначе создается новый и
+ * добавляется в список. Буферы не освобождаются до конца программы.
+ *
+ * @return TraceRing_t* Буфер (NULL - не хватило памяти).
+ */
+static TraceRing_t *traceClaim(void) {
+  TraceRing_t *ring = __atomic_load_n(&traceRings, __ATOMIC_ACQUIRE);
+  int released = 0;
+  while (ring && !__atomic_compare_exchange_n(&ring->owned, &released, 1,
+                                              false, __ATOMIC_ACQ_REL,
+                                              __ATOMIC_RELAXED)) {
+    released = 0;
+    ring = ring->next;
+  }
+  if (!ring) {
+    ring = (TraceRing_t *)calloc(1, sizeof(*ring));
+    if (ring) {
+      ring->owned = 1;
+      ring->tid = __atomic_add_fetch(&traceRingCount, 1, __ATOMIC_RELAXED);
+      ring->next = __atomic_load_n(&traceRings, __ATOMIC_RELAXED);
+      while (!__atomic_compare_exchange_n(&traceRings, &ring->next, ring, true,
+                                          __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED)) {
+      }
+    }
+  }
+  if (ring) {
+    pthread_once(&traceKeyOnce, traceKeyCreate);
+    pthread_setspecific(traceKey, ring);
+  }
+  return ring;
+}
+
+/**
+ * @brief Включена ли трассировка в этой сборке.
+ *
+ * @return true Сборка с TRACE_EVENTS.
+ */
+bool traceEnabled(void) {
+#ifdef TRACE_EVENTS
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Открывает интервал.
+ *
+ * @param name Имя интервала (строковый литерал без кавычек и обратных
+ * слешей: в файл он попадает как есть).
+ * @return TraceSpan_t Интервал для traceSpanEnd.
+ */
+TraceSpan_t traceSpanBegin(const char *name) {
+  TraceSpan_t span = {name, traceNow()};
+  return span;
+}
+
+/**
+ * @brief Закрывает интервал и записывает его в буфер потока.
+ *
+ * Принимает указатель, чтобы вызываться при выходе из блока
+ * (__attribute__((cleanup)) в TRACE_SPAN). Первый интервал потока
+ * занимает для него буфер.
+ *
+ * @param span Интервал, который вернул traceSpanBegin.
+ */
+void traceSpanEnd(const TraceSpan_t *span) {
+  int64_t endNs = traceNow();
+  if (!traceLocal) traceLocal = traceClaim();
+  TraceRing_t *ring = traceLocal;
+  if (ring) {
+    uint64_t head = ring->head;
+    TraceEvent_t *event = &ring->events[head % TRACE_RING_EVENTS];
+    event->name = span->name;
+    event->beginNs = span->beginNs;
+    event->durationNs = endNs - span->beginNs;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+  }
+}
+
+/**
+ * @brief Записывает накопленные байты в файл.
+ *
+ * @param writer Буфер вывода.
+ */
+static void traceWriteFlush(TraceWriter_t *writer) {
+  size_t done = 0;
+  while (writer->ok && done < writer->length) {
+    ssize_t written =
+        write(writer->fd, writer->data + done, writer->length - done);
+    if (written > 0) {
+      done += (size_t)written;
+    } else if (written == 0 || errno != EINTR) {
+      writer->ok = false;
+    }
+  }
+  writer->length = 0;
+}
+
+/**
+ * @brief Добавляет строку в буфер вывода.
+ *
+ * @param writer Буфер вывода.
+ * @param text Строка.
+ */
+static void traceWriteText(TraceWriter_t *writer, const char *text) {
+  for (; *text; text++) {
+    if (writer->length == sizeof(writer->data)) traceWriteFlush(writer);
+    writer->data[writer->length++] = *text;
+  }
+}
+
+/**
+ * @brief Добавляет неотрицательное число в буфер вывода.
+ *
+ * @param writer Буфер вывода.
+ * @param value Число.
+ * @param width Наименьшее количество цифр (дополняется нулями слева).
+ */
+static void traceWriteNumber(TraceWriter_t *writer, int64_t value,
+                             int width) {
+  char digits[24];
+  int length = sizeof(digits) - 1;
+  digits[length] = '\0';
+  uint64_t rest = value > 0 ? (uint64_t)value : 0;
+  do {
+    digits[--length] = (char)('0' + rest % 10);
+    rest /= 10;
+  } while (rest || (int)sizeof(digits) - 1 - length < width);
+  traceWriteText(writer, digits + length);
+}
+
+/**
+ * @brief Добавляет время в микросекундах (единица ts и dur в trace_event)
+ * с точностью до наносекунды.
+ *
+ * @param writer Буфер вывода.
+ * @param ns Время в наносекундах.
+ */
+static void traceWriteMicros(TraceWriter_t *writer, int64_t ns) {
+  traceWriteNumber(writer, ns / 1000, 1);
+  traceWriteText(writer, ".");
+  traceWriteNumber(writer, ns % 1000, 3);
+}
+
+/**
+ * @brief Сохраняет интервалы всех потоков в JSON формата Chrome
+ * trace_event.
+ *
+ * Каждый интервал - событие "X" (complete) с началом и длительностью в
+ * микросекундах; tid - номер буфера потока. Буферы читаются без
+ * блокировок, пока потоки продолжают писать: событие, которое поток успел
+ * затереть во время чтения, пропускается, поэтому из полного буфера
+ * сохраняются последние TRACE_RING_EVENTS - 1 событий. Функция использует
+ * только async-signal-safe вызовы и может работать в обработчике сигнала.
+ *
+ * @param path Путь к файлу (TRACE_FILE); файл перезаписывается.
+ * @return true Файл записан.
+ */
+bool traceFlush(const char *path) {
+  TraceWriter_t writer;
+  writer.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  writer.ok = writer.fd >= 0;
+  writer.length = 0;
+  int64_t pid = getpid();
+  const char *separator = "\n";
+  traceWriteText(&writer, "{\"traceEvents\":[");
+  TraceRing_t *ring = __atomic_load_n(&traceRings, __ATOMIC_ACQUIRE);
+  for (; ring && writer.ok; ring = ring->next) {
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t first = head >= TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS + 1
+                                               : 0;
+    for (uint64_t i = first; i < head; i++) {
+      TraceEvent_t event = ring->events[i % TRACE_RING_EVENTS];
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&ring->head, __ATOMIC_RELAXED) - i >=
+          TRACE_RING_EVENTS) {
+        continue;
+      }
+      traceWriteText(&writer, separator);
+      separator = ",\n";
+      traceWriteText(&writer, "{\"name\":\"");
+      traceWriteText(&writer, event.name);
+      traceWriteText(&writer, "\",\"cat\":\"game\",\"ph\":\"X\",\"pid\":");
+      traceWriteNumber(&writer, pid, 1);
+      traceWriteText(&writer, ",\"tid\":");
+      traceWriteNumber(&writer, ring->tid, 1);
+      traceWriteText(&writer, ",\"ts\":");
+      traceWriteMicros(&writer, event.beginNs);
+      traceWriteText(&writer, ",\"dur\":");
+      traceWriteMicros(&writer, event.durationNs);
+      traceWriteText(&writer, "}");
+    }
+  }
+  traceWriteText(&writer, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  traceWriteFlush(&writer);
+  if (writer.fd >= 0) close(writer.fd);
+  return writer.ok;
+}
+
+#ifdef TRACE_EVENTS
+/// Файл, который пишут traceFlushAtExit и traceSignal.
+static const char *tracePath;
+/// Прежние обработчики SIGINT и SIGTERM.
+static struct sigaction tracePrevious[2];
+
+/**
+ * @brief Сохраняет трассировку при выходе из программы.
+ */
+static void traceFlushAtExit(void) { traceFlush(tracePath); }
+
+/**
+ * @brief Сохраняет трассировку по сигналу.
+ *
+ * SIGUSR1 только сохраняет снимок. Для SIGINT и SIGTERM после сохранения
+ * восстанавливается прежний обработчик (например, обработчик ncurses,
+ * возвращающий терминал в исходный режим), и сигнал посылается снова.
+ *
+ * @param signum Номер сигнала.
+ */
+static void traceSignal(int signum) {
+  int savedErrno = errno;
+  traceFlush(tracePath);
+  if (signum != SIGUSR1) {
+    sigaction(signum, &tracePrevious[signum == SIGTERM], NULL);
+    raise(signum);
+  }
+  errno = savedErrno;
+}
+#endif
+
+/**
+ * @brief Сохраняет трассировку в path при выходе из программы, по SIGUSR1 и
+ * по SIGINT/SIGTERM.
+ *
+ * Вызывается один раз после настройки терминала (initscr), чтобы
+ * обработчики сигналов ncurses остались в цепочке.
+ *
+ * @param path Путь к файлу (TRACE_FILE).
+ * @return true Обработчики установлены, false - сборка без TRACE_EVENTS
+ * или ошибка.
+ */
+bool traceInstall(const char *path) {
+  bool installed = false;
+#ifdef TRACE_EVENTS
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = traceSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  tracePath = path;
+  installed = atexit(traceFlushAtExit) == 0 &&
+              sigaction(SIGUSR1, &action, NULL) == 0 &&
+              sigaction(SIGINT, &action, &tracePrevious[0]) == 0 &&
+              sigaction(SIGTERM, &action, &tracePrevious[1]) == 0;
+#else
+  (void)path;
+#endif
+  return installed;
+}
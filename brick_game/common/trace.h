@@ -0,0 +1,64 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_TRACE_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_TRACE_H_
+#define TRACE_RING_EVENTS (1 << 16)
+#define TRACE_FILE "trace.json"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup CommonTrace Trace Events
+ * Трассировка фаз игрового цикла в формате Chrome trace_event.
+ *
+ * В сборке с TRACE_EVENTS (make TRACE_EVENTS=1 ...) макрос TRACE_SPAN в
+ * начале функции отмечает интервал от этого места до выхода из нее. Каждый
+ * поток пишет интервалы в свой кольцевой буфер на TRACE_RING_EVENTS
+ * событий без блокировок и системных вызовов, кроме чтения часов; при
+ * переполнении затираются самые старые. traceFlush сохраняет все буферы в
+ * JSON, который открывается в Perfetto или chrome://tracing. traceInstall
+ * вызывает его при выходе из программы, по SIGUSR1 (снимок без остановки)
+ * и по SIGINT/SIGTERM.
+ *
+ * Буфер завершившегося потока остается в списке: его события попадают в
+ * файл, пока буфер не займет новый поток и не затрет их.
+ *
+ * Без TRACE_EVENTS макрос TRACE_SPAN пуст, а traceInstall ничего не
+ * устанавливает.
+ * @{
+ */
+
+/**
+ * @brief Открытый интервал трассировки.
+ */
+typedef struct {
+  const char *name;  ///< Имя интервала (строковый литерал без кавычек).
+  int64_t beginNs;   ///< Начало интервала (CLOCK_MONOTONIC).
+} TraceSpan_t;
+
+#ifdef TRACE_EVENTS
+/// Отмечает интервал name от этого места до конца текущего блока.
+#define TRACE_SPAN(name)                                \
+  TraceSpan_t traceSpan_                                \
+      __attribute__((cleanup(traceSpanEnd))) =          \
+          traceSpanBegin(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+bool traceEnabled(void);
+TraceSpan_t traceSpanBegin(const char *name);
+void traceSpanEnd(const TraceSpan_t *span);
+bool traceFlush(const char *path);
+bool traceInstall(const char *path);
+
+/** @} */  // CommonTrace
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_COMMON_TRACE_H_
@@ -7,16 +7,65 @@ namespace s21 {
  *
  * @param game Указатель на объект класса Snake.
  */
-Controller::Controller(Snake *game) : game(game) {}
+Controller::Controller(Snake *game) : game(game) {
+  simFramesInit(&frames_);
+  simThreadInit(&thread_, ThreadStep, this);
+  tickInit(&ticks_, game->gameInfo.speed * TICK_NS_PER_MS, tickNow());
+  Publish();
+}
+
+/**
+ * @brief Конструктор снимка: связывает info с массивами снимка.
+ */
+SnakeSnapshot::SnakeSnapshot() noexcept
+    : info{},
+      cells{},
+      apple{},
+      body{},
+      length(0),
+      sequence(0),
+      rowSequence{},
+      hudSequence{} {
+  for (int i = 0; i < HEIGHT; i++) rows[i] = cells[i];
+  appleRow[0] = apple;
+  info.field = rows;
+  info.next = appleRow;
+}
+
+/**
+ * @brief Изменения снимка по сравнению с показанным ранее.
+ *
+ * @param shown Номер снимка, который сейчас на экране.
+ * @return FrameDiff_t Строки поля и значения панели, изменившиеся в
+ * публикациях после shown.
+ */
+FrameDiff_t SnakeSnapshot::ChangesSince(uint64_t shown) const noexcept {
+  FrameDiff_t diff = {0, 0};
+  for (int i = 0; i < HEIGHT; i++) {
+    if (rowSequence[i] > shown) diff.rows |= 1u << i;
+  }
+  for (int k = 0; k < FRAME_HUD_ITEMS; k++) {
+    if (hudSequence[k] > shown) diff.hud |= 1 << k;
+  }
+  return diff;
+}
 
 /**
  * @brief Функция обработки переданной командой
  *
+ * Время, пока игра не шла (пауза, ожидание старта), пропускается при ее
+ * запуске, даже если updateCurrentState в это время не вызывался. Если
+ * задан SetLatency, записывается задержка от нажатия до обработки.
+ *
  * @param action Действие игрока
  * @param game Показатель зажатия клавиши
  *
  */
 void Controller::userInput(UserAction_t action, bool hold) {
+  ALLOC_PHASE(ALLOC_INPUT);
+  TRACE_SPAN("Controller::userInput");
+  if (recording_) replayInput(&replay_, action, hold);
+  bool running = game->gameInfo.pause == STARTED;
   if (game->gameInfo.pause == STARTED) {
     if (game->flagMoved) {
       switch (action) {
@@ -54,30 +103,251 @@ void Controller::userInput(UserAction_t action, bool hold) {
     default:
       break;
   }
+  if (!running && game->gameInfo.pause == STARTED) {
+    tickSkip(&ticks_, tickNow());
+  }
+  if (latency_) latencyKeyApplied(latency_, tickNow());
+  Publish();
 }
 
 /**
  * @brief Функция обновления игрового состояния
  *
+ * Выполняет шаги змейки, накопленные планировщиком тактов (период равен
+ * gameInfo.speed мс), и публикует новый снимок. Пока игра не идет, время
+ * пропускается. Если задан SetLatency, записывается длительность каждого
+ * шага.
+ *
+ * @return GameInfo_t Состояние из опубликованного снимка (field и next
+ * указывают на массивы снимка).
  */
 GameInfo_t Controller::updateCurrentState() {
-  GameInfo_t gm;
-  struct timespec current;
-  double difference;
-  clock_gettime(CLOCK_REALTIME, &current);
-  difference = (current.tv_sec - game->last_move_time.tv_sec) * 1000 +
-               ((current.tv_nsec - game->last_move_time.tv_nsec)) / 1000000;
-  if (difference >= game->gameInfo.speed) {
-    game->MovingSnake();
-    game->last_move_time = current;
+  ALLOC_PHASE(ALLOC_TICK);
+  TRACE_SPAN("Controller::updateCurrentState");
+  int64_t now = tickNow();
+  if (game->gameInfo.pause == STARTED) {
+    tickSetPeriod(&ticks_, game->gameInfo.speed * TICK_NS_PER_MS);
+    for (int steps = tickAdvance(&ticks_, now); steps > 0; steps--) {
+      int64_t start = latency_ ? tickNow() : 0;
+      Step();
+      if (latency_) latencyRecord(&latency_->tick, tickNow() - start);
+    }
+  } else {
+    tickSkip(&ticks_, now);
+  }
+  Publish();
+  return snapshots_[frames_.published].info;
+}
+
+/**
+ * @brief Копирует состояние модели в свободный снимок и публикует его.
+ *
+ * Снимки лежат в тройном буфере: запись идет в слот писателя, затем он
+ * атомарно меняется местами со слотом обмена. Снимок, полученный через
+ * Snapshot(), не перезаписывается, пока читатель не запросит следующий,
+ * поэтому поток отрисовки читает его без блокировок и копирования.
+ */
+void Controller::Publish() noexcept {
+  ALLOC_PHASE(ALLOC_RENDER);
+  SnakeSnapshot &snapshot = snapshots_[frames_.back];
+  const SnakeSnapshot &previous = snapshots_[frames_.published];
+  const GameInfo_t &info = game->gameInfo;
+  if (!game->GetFlagErrorGame()) {
+    std::copy_n(info.field[0], HEIGHT * WIDTH, &snapshot.cells[0][0]);
+    snapshot.apple[0] = info.next[0][0];
+    snapshot.apple[1] = info.next[0][1];
+  }
+  snapshot.length =
+      std::copy(game->snakeCoordinates.begin(), game->snakeCoordinates.end(),
+                snapshot.body) -
+      snapshot.body;
+  snapshot.info.score = info.score;
+  snapshot.info.high_score = info.high_score;
+  snapshot.info.level = info.level;
+  snapshot.info.speed = info.speed;
+  snapshot.info.pause = info.pause;
+  snapshot.sequence = ++sequence_;
+  uint32_t rows = game->TakeDirtyRows();
+  for (int i = 0; i < HEIGHT; i++) {
+    snapshot.rowSequence[i] =
+        rows & (1u << i) ? sequence_ : previous.rowSequence[i];
+  }
+  FrameHud_t before = {previous.info.score, previous.info.high_score,
+                       previous.info.level, 0, previous.info.pause};
+  FrameHud_t after = {info.score, info.high_score, info.level, 0, info.pause};
+  int hud = frameHudDiff(&before, &after);
+  for (int k = 0; k < FRAME_HUD_ITEMS; k++) {
+    snapshot.hudSequence[k] =
+        hud & (1 << k) ? sequence_ : previous.hudSequence[k];
   }
+  if (simFramesPublish(&frames_) && onFrame_) onFrame_();
+}
 
-  return gm;
+/**
+ * @brief Время до следующего шага змейки.
+ *
+ * @return int64_t Наносекунды, которые фронтенд может ждать ввода.
+ */
+int64_t Controller::UntilNextTickNs() const noexcept {
+  return tickUntilNext(&ticks_, tickNow());
+}
+
+/**
+ * @brief Последний опубликованный снимок состояния игры.
+ *
+ * Снимки читает один поток (поток отрисовки или, без потока игры, поток
+ * фронтенда).
+ *
+ * @return const SnakeSnapshot& Снимок, неизменный до следующего вызова
+ * Snapshot().
+ */
+const SnakeSnapshot &Controller::Snapshot() const noexcept {
+  simFramesAcquire(&frames_);
+  return snapshots_[frames_.front];
+}
+
+/**
+ * @brief Задает уведомление о новом снимке.
+ *
+ * Уведомление вызывается из потока игры, только когда читатель уже забрал
+ * предыдущий снимок, поэтому несколько публикаций подряд дают одно
+ * уведомление. После OnFrame читатель должен забрать текущий снимок
+ * (Snapshot), иначе уведомлений не будет.
+ *
+ * @param notify Функция уведомления (пустая - не уведомлять).
+ */
+void Controller::OnFrame(std::function<void()> notify) {
+  onFrame_ = std::move(notify);
+}
+
+/**
+ * @brief Запускает поток игры.
+ *
+ * После запуска ввод передается только через Post, а состояние читается
+ * только через Snapshot().
+ *
+ * @return true Поток запущен, false - Run вызывает фронтенд.
+ */
+bool Controller::StartThread() noexcept {
+  tickSkip(&ticks_, tickNow());
+  return simThreadStart(&thread_);
+}
+
+/**
+ * @brief Останавливает поток игры; после этого модель снова доступна
+ * напрямую.
+ */
+void Controller::StopThread() noexcept { simThreadStop(&thread_); }
+
+/**
+ * @brief Проверяет, работает ли поток игры.
+ *
+ * @return true Поток игры запущен.
+ */
+bool Controller::Threaded() const noexcept { return thread_.started; }
+
+/**
+ * @brief Передает ввод игре без ожидания.
+ *
+ * Событие ставится в очередь, поток игры будится. Без потока событие
+ * обработает следующий вызов Run.
+ *
+ * @param action Действие игрока
+ * @param hold Показатель зажатия клавиши
+ * @return true Событие принято, false - очередь заполнена.
+ */
+bool Controller::Post(UserAction_t action, bool hold) noexcept {
+  return simThreadPost(&thread_, action, hold);
+}
+
+/**
+ * @brief Шаг игры: ввод из очереди, накопленные шаги змейки, новый снимок.
+ *
+ * @return int64_t Наносекунды до следующего шага или -1, если игра не идет
+ * и следующий шаг нужен только после ввода.
+ */
+int64_t Controller::Run() noexcept {
+  SimInput_t input;
+  while (simQueuePop(&thread_.input, &input)) {
+    userInput(static_cast<UserAction_t>(input.action), input.hold);
+  }
+  updateCurrentState();
+  return game->gameInfo.pause == STARTED ? UntilNextTickNs() : -1;
+}
+
+/**
+ * @brief Шаг игры для потока: Run с аргументом void *.
+ *
+ * @param controller Указатель на Controller.
+ */
+int64_t Controller::ThreadStep(void *controller) noexcept {
+  return static_cast<Controller *>(controller)->Run();
+}
+
+/**
+ * @brief Один шаг змейки без проверки времени
+ *
+ * Шаг отмечается в записи партии как такт.
+ */
+void Controller::Step() noexcept {
+  if (recording_) replayTick(&replay_);
+  game->MovingSnake();
+}
+
+/**
+ * @brief Начинает запись партии
+ *
+ * Все последующие вызовы userInput и шаги змейки попадают в запись.
+ */
+void Controller::StartRecording() noexcept {
+  replayFree(&replay_);
+  replayInit(&replay_, REPLAY_SNAKE, game->GetSeed());
+  recording_ = true;
+}
+
+/**
+ * @brief Сохраняет запись партии в каталог архива
+ *
+ * Пустая запись (партия без ввода) не сохраняется. После вызова запись
+ * партии заканчивается: повторный вызов ничего не сохраняет, запись
+ * остается доступной через GetReplay до следующего StartRecording.
+ *
+ * @param dir Каталог архива.
+ * @return true Если запись сохранена.
+ */
+bool Controller::SaveReplay(const char *dir) noexcept {
+  bool saved = recording_ && replay_.events &&
+               replayArchive(&replay_, dir, game->gameInfo.score);
+  recording_ = false;
+  return saved;
+}
+
+/**
+ * @brief Получение записи партии
+ *
+ * @return const Replay_t& Запись партии.
+ */
+const Replay_t &Controller::GetReplay() const noexcept { return replay_; }
+
+/**
+ * @brief Задает гистограммы задержек игры
+ *
+ * Контроллер записывает в них длительность шагов змейки и задержку от
+ * нажатия (latencyKeyPressed во фронтенде) до его обработки. Гистограммы
+ * принадлежат фронтенду и должны жить дольше контроллера.
+ *
+ * @param latency Гистограммы (nullptr - не измерять).
+ */
+void Controller::SetLatency(LatencyStats_t *latency) noexcept {
+  latency_ = latency;
 }
 
 /**
  * @brief Деструктор класса Controller.
  *
  */
-Controller::~Controller() noexcept {}
+Controller::~Controller() noexcept {
+  StopThread();
+  replayFree(&replay_);
+}
 }  // namespace s21
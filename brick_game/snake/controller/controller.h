@@ -1,21 +1,95 @@
 #ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_SNAKE_CONTROLLER_CONTROLLER_H_
 #define CPP3_BRICKGAME_SRC_BRICK_GAME_SNAKE_CONTROLLER_CONTROLLER_H_
+#include <functional>
+
+#include "../../common/latency.h"
+#include "../../common/replay.h"
+#include "../../common/sim_thread.h"
+#include "../../common/tick_scheduler.h"
 #include "../model/snake.h"
 
 namespace s21 {
 
+/**
+ * @brief Неизменяемый снимок состояния игры для отрисовки.
+ * @ingroup SnakeGame
+ *
+ * Снимок не ссылается на модель: поле, яблоко и тело змейки скопированы в
+ * него, а info.field и info.next указывают на собственные массивы снимка.
+ * Поэтому снимок нельзя копировать. Номера публикаций строк и панели
+ * позволяют фронтенду перерисовать только то, что изменилось после
+ * показанного им снимка, даже если промежуточные снимки он пропустил.
+ */
+struct SnakeSnapshot {
+  GameInfo_t info;           ///< Счет, уровень, статус и поле снимка
+  int cells[HEIGHT][WIDTH];  ///< Клетки поля
+  int *rows[HEIGHT];         ///< Строки cells для info.field
+  int apple[2];              ///< Координаты яблока (x, y)
+  int *appleRow[1];          ///< Строка apple для info.next
+  /// Координаты змейки от головы к хвосту
+  Snake::SnakeElement body[WIDTH * HEIGHT + 1];
+  size_t length;      ///< Длина змейки
+  uint64_t sequence;  ///< Номер публикации (0 - не опубликован)
+  /// Номер публикации, в которой последний раз изменилась строка поля
+  uint64_t rowSequence[HEIGHT];
+  /// Номер публикации, в которой последний раз изменилось значение панели
+  /// (индекс - номер бита FRAME_*)
+  uint64_t hudSequence[FRAME_HUD_ITEMS];
+
+  SnakeSnapshot() noexcept;
+  FrameDiff_t ChangesSince(uint64_t shown) const noexcept;
+  SnakeSnapshot(const SnakeSnapshot &) = delete;
+  SnakeSnapshot &operator=(const SnakeSnapshot &) = delete;
+};
+
 /**
  * @brief Класс Контроллера. Отвечает за взаимодействие Модели и Консоли
  * @ingroup SnakeGame
+ *
+ * Контроллер работает в потоке фронтенда (userInput, updateCurrentState)
+ * или в собственном потоке игры (StartThread): тогда ввод передается через
+ * Post без блокировок, а фронтенд только читает снимки.
  */
 class Controller {
  public:
   Snake *game;  ///< Сыллка на объект класса Snake
 
   Controller(Snake *game);
+  Controller(const Controller &) = delete;
+  Controller &operator=(const Controller &) = delete;
   ~Controller() noexcept;
   void userInput(UserAction_t action, bool hold);
   GameInfo_t updateCurrentState();
+  void Step() noexcept;
+
+  void StartRecording() noexcept;
+  bool SaveReplay(const char *dir) noexcept;
+  const Replay_t &GetReplay() const noexcept;
+  void SetLatency(LatencyStats_t *latency) noexcept;
+
+  const SnakeSnapshot &Snapshot() const noexcept;
+  int64_t UntilNextTickNs() const noexcept;
+
+  void OnFrame(std::function<void()> notify);
+  bool StartThread() noexcept;
+  void StopThread() noexcept;
+  bool Threaded() const noexcept;
+  bool Post(UserAction_t action, bool hold) noexcept;
+  int64_t Run() noexcept;
+
+ private:
+  Replay_t replay_{};                    ///< Запись партии
+  bool recording_ = false;               ///< Партия записывается
+  SnakeSnapshot snapshots_[SIM_FRAMES];  ///< Снимки тройного буфера
+  mutable SimFrames_t frames_;           ///< Слоты снимков
+  uint64_t sequence_ = 0;                ///< Номер последней публикации
+  TickScheduler_t ticks_;                ///< Планировщик шагов змейки
+  SimThread_t thread_;                   ///< Поток игры и очередь ввода
+  std::function<void()> onFrame_;        ///< Уведомление о новом снимке
+  LatencyStats_t *latency_ = nullptr;    ///< Гистограммы шагов и ввода
+
+  void Publish() noexcept;
+  static int64_t ThreadStep(void *controller) noexcept;
 };
 
 }  // namespace s21
@@ -0,0 +1,134 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_SNAKE_MODEL_RING_BUFFER_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_SNAKE_MODEL_RING_BUFFER_H_
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace s21 {
+
+/**
+ * @brief Кольцевой буфер фиксированной емкости.
+ * @ingroup SnakeGame
+ *
+ * Память выделяется один раз в конструкторе. Добавление в начало и удаление
+ * с конца выполняются за O(1) без сдвига элементов. Элемент 0 - начало
+ * (голова змейки), элемент size() - 1 - конец (хвост).
+ *
+ * @tparam T Тип элемента.
+ */
+template <typename T>
+class RingBuffer {
+ public:
+  /**
+   * @brief Итератор по элементам от начала к концу.
+   */
+  class ConstIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    ConstIterator(const RingBuffer *buffer, size_t index) noexcept
+        : buffer_(buffer), index_(index) {}
+    reference operator*() const noexcept { return (*buffer_)[index_]; }
+    pointer operator->() const noexcept { return &(*buffer_)[index_]; }
+    ConstIterator &operator++() noexcept {
+      ++index_;
+      return *this;
+    }
+    ConstIterator operator++(int) noexcept {
+      ConstIterator previous = *this;
+      ++index_;
+      return previous;
+    }
+    bool operator==(const ConstIterator &other) const noexcept {
+      return index_ == other.index_ && buffer_ == other.buffer_;
+    }
+    bool operator!=(const ConstIterator &other) const noexcept {
+      return !(*this == other);
+    }
+
+   private:
+    const RingBuffer *buffer_;  ///< Обходимый буфер
+    size_t index_;              ///< Номер элемента от начала
+  };
+
+  /**
+   * @brief Создает пустой буфер.
+   *
+   * @param capacity Максимальное количество элементов (не меньше 1).
+   */
+  explicit RingBuffer(size_t capacity)
+      : data_(capacity ? capacity : 1), head_(0), size_(0) {}
+
+  /**
+   * @brief Добавляет элемент в начало.
+   *
+   * Если буфер заполнен, последний элемент вытесняется.
+   *
+   * @param value Новый первый элемент.
+   */
+  void push_front(const T &value) noexcept {
+    if (size_ == data_.size()) pop_back();
+    head_ = head_ ? head_ - 1 : data_.size() - 1;
+    data_[head_] = value;
+    size_++;
+  }
+
+  /**
+   * @brief Удаляет последний элемент, если буфер не пуст.
+   */
+  void pop_back() noexcept {
+    if (size_) size_--;
+  }
+
+  /**
+   * @brief Заменяет содержимое элементами диапазона.
+   *
+   * Элементы сверх емкости отбрасываются.
+   */
+  template <typename Iterator>
+  void assign(Iterator first, Iterator last) {
+    clear();
+    for (; first != last && size_ < data_.size(); ++first) {
+      data_[size_++] = *first;
+    }
+  }
+
+  /**
+   * @brief Удаляет все элементы.
+   */
+  void clear() noexcept {
+    head_ = 0;
+    size_ = 0;
+  }
+
+  /**
+   * @brief Элемент по номеру от начала (без проверки границ).
+   */
+  const T &operator[](size_t index) const noexcept {
+    size_t position = head_ + index;
+    if (position >= data_.size()) position -= data_.size();
+    return data_[position];
+  }
+
+  const T &front() const noexcept { return data_[head_]; }
+  const T &back() const noexcept { return (*this)[size_ - 1]; }
+  size_t size() const noexcept { return size_; }
+  size_t capacity() const noexcept { return data_.size(); }
+  bool empty() const noexcept { return size_ == 0; }
+  ConstIterator begin() const noexcept { return ConstIterator(this, 0); }
+  ConstIterator end() const noexcept { return ConstIterator(this, size_); }
+
+ private:
+  std::vector<T> data_;  ///< Хранилище элементов
+  size_t head_;          ///< Позиция первого элемента в data_
+  size_t size_;          ///< Количество элементов
+};
+
+}  // namespace s21
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_SNAKE_MODEL_RING_BUFFER_H_
@@ -2,11 +2,33 @@
 
 namespace s21 {
 
+/**
+ * @brief Конструктор Snake со случайным зерном.
+ */
+Snake::Snake() : Snake(static_cast<uint64_t>(std::random_device{}()) << 32 ^
+                       static_cast<uint64_t>(time(nullptr))) {}
+
 /**
  * @brief Конструктор Snake.
- * Инициализирует начальные данные
+ * Инициализирует начальные данные. Позиции яблок определяются только зерном,
+ * поэтому одинаковое зерно и одинаковый ввод дают одинаковую игру.
+ *
+ * Без файла рекорда (scoreFile == nullptr) рекорд начинается с 0 и никуда
+ * не записывается: так воспроизводятся чужие записи партий.
+ *
+ * @param seed Зерно генератора яблок.
+ * @param scoreFile Файл рекорда (по умолчанию SCORE_FILE_SNAKE).
  */
-Snake::Snake() {
+Snake::Snake(uint64_t seed, const char *scoreFile)
+    : snakeCoordinates(WIDTH * HEIGHT + 1),
+      seed_(seed),
+      random_(seed),
+      scoreStore_(scoreFile ? scoreStoreOpen(scoreFile) : nullptr),
+      occupancy_(WIDTH * HEIGHT, 0),
+      freeCells_(WIDTH * HEIGHT),
+      freePosition_(WIDTH * HEIGHT),
+      freeCount_(0),
+      dirtyRows_(FRAME_ROWS(HEIGHT)) {
   flagError_ = false;
 
   gameInfo.pause = NOT_STARTED;
@@ -20,65 +42,51 @@ Snake::Snake() {
 
   SetDirection(Up);
 
-  clock_gettime(CLOCK_REALTIME, &last_move_time);
   flagMoved = true;
-  flagError_ = CreateField(&gameInfo.field, HEIGHT, WIDTH);
-  if (!flagError_) {
-    flagError_ = CreateField(&gameInfo.next, 1, 2);
-    if (!flagError_) GenerateApple();
-  }
+  flagError_ = CreateField(&field_, HEIGHT, WIDTH);
+  if (!flagError_) flagError_ = CreateField(&apple_, 1, 2);
+  gameInfo.field = field_.rows;
+  gameInfo.next = apple_.rows;
+  if (!flagError_) GenerateApple();
 }
 
 /**
  * @brief Деструктор Snake.
- * Освобождает память, выделенную для игрового поля
+ * Освобождает память, выделенную для игрового поля, и дожидается записи
+ * рекорда.
  */
 Snake::~Snake() noexcept {
-  for (int i = 0; i < HEIGHT; i++) delete[] gameInfo.field[i];
-  delete[] gameInfo.field;
-  for (int i = 0; i < 1; i++) delete[] gameInfo.next[i];
-  delete[] gameInfo.next;
+  scoreStoreFlush(scoreStore_);
+  fieldDestroy(&field_);
+  fieldDestroy(&apple_);
 }
 
 /**
- * @brief Создает игровое поле.
+ * @brief Создает игровое поле одним непрерывным блоком памяти.
  *
  * @param field Указатель на поле.
  * @param m Количество строк.
  * @param n Количество столбцов.
- * @return bool Возвращает true, если поле успешно создано, или false при
+ * @return bool Возвращает false, если поле успешно создано, или true при
  * ошибке.
  */
-bool Snake::CreateField(int ***field, int m, int n) {
-  *field = new int *[m];  //
-  if (*field == NULL) {
+bool Snake::CreateField(Field_t *field, int m, int n) {
+  if (!fieldCreate(field, m, n)) {
     flagError_ = true;
-  } else {
-    for (int i = 0; i < m && !flagError_; i++) {
-      (*field)[i] = new int[n];
-      if ((*field)[i] == NULL) {
-        for (int j = 0; j < i; j++) {
-          delete[] (*field)[j];
-        }
-        flagError_ = true;
-      }
-    }
   }
-  if (!flagError_) InitialField(field, m, n);
+  if (!flagError_) InitialField(field);
   return flagError_;
 }
 
 /**
- * @brief Инициализирует игровое поле нулями.
+ * @brief Заполняет игровое поле шахматным узором.
  *
  * @param field Указатель на поле.
- * @param m Количество строк.
- * @param n Количество столбцов.
  */
-void Snake::InitialField(int ***field, int m, int n) {
-  for (int i = 0; i < m; i++) {
-    for (int j = 0; j < n; j++) {
-      (*field)[i][j] = 13 - (i + j) % 2;
+void Snake::InitialField(Field_t *field) {
+  for (int i = 0; i < field->height; i++) {
+    for (int j = 0; j < field->width; j++) {
+      field->rows[i][j] = 13 - (i + j) % 2;
     }
   }
 }
@@ -88,10 +96,105 @@ void Snake::InitialField(int ***field, int m, int n) {
  */
 void Snake::InitialSnake() {
   if (!flagError_)
-    snakeCoordinates = {{WIDTH / 2, HEIGHT / 2 - 1},
-                        {WIDTH / 2, HEIGHT / 2},
-                        {WIDTH / 2, HEIGHT / 2 + 1},
-                        {WIDTH / 2, HEIGHT / 2 + 2}};
+    SetSnake({{WIDTH / 2, HEIGHT / 2 - 1},
+              {WIDTH / 2, HEIGHT / 2},
+              {WIDTH / 2, HEIGHT / 2 + 1},
+              {WIDTH / 2, HEIGHT / 2 + 2}});
+}
+
+/**
+ * @brief Заменяет тело змейки и перестраивает карту занятых и свободных
+ * клеток.
+ *
+ * snakeCoordinates нельзя менять напрямую: карта занятых клеток
+ * обновляется только здесь и при движении змейки.
+ *
+ * @param snake Координаты змейки, начиная с головы.
+ */
+void Snake::SetSnake(const std::vector<SnakeElement> &snake) {
+  snakeCoordinates.assign(snake.begin(), snake.end());
+  std::fill(occupancy_.begin(), occupancy_.end(), 0);
+  for (int cell = 0; cell < WIDTH * HEIGHT; cell++) {
+    freeCells_[cell] = cell;
+    freePosition_[cell] = cell;
+  }
+  freeCount_ = WIDTH * HEIGHT;
+  for (const auto &segment : snakeCoordinates) Occupy(segment);
+  dirtyRows_ = FRAME_ROWS(HEIGHT);
+}
+
+/**
+ * @brief Индекс клетки в карте занятых клеток.
+ *
+ * @return int Индекс или -1 для клетки вне поля.
+ */
+int Snake::CellIndex(int x, int y) const noexcept {
+  bool inside = x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT;
+  return inside ? y * WIDTH + x : -1;
+}
+
+/**
+ * @brief Перемещает клетку на позицию position в freeCells_.
+ *
+ * Клетка, стоявшая на этой позиции, занимает прежнее место cell.
+ */
+void Snake::SwapFreeCell(int cell, size_t position) noexcept {
+  int other = freeCells_[position];
+  size_t from = freePosition_[cell];
+  freeCells_[from] = other;
+  freePosition_[other] = from;
+  freeCells_[position] = cell;
+  freePosition_[cell] = position;
+}
+
+/**
+ * @brief Отмечает сегмент змейки в карте занятых клеток.
+ *
+ * Клетка, занятая первым сегментом, уходит из множества свободных.
+ */
+void Snake::Occupy(const SnakeElement &cell) noexcept {
+  int index = CellIndex(cell.x, cell.y);
+  if (index >= 0 && occupancy_[index]++ == 0) {
+    SwapFreeCell(index, --freeCount_);
+  }
+  MarkRow(cell.y);
+}
+
+/**
+ * @brief Снимает отметку сегмента змейки с карты занятых клеток.
+ *
+ * Клетка, освобожденная последним сегментом, возвращается в множество
+ * свободных.
+ */
+void Snake::Release(const SnakeElement &cell) noexcept {
+  int index = CellIndex(cell.x, cell.y);
+  if (index >= 0 && occupancy_[index] && --occupancy_[index] == 0) {
+    SwapFreeCell(index, freeCount_++);
+  }
+  MarkRow(cell.y);
+}
+
+/**
+ * @brief Отмечает строку поля как изменившуюся.
+ *
+ * @param y Строка (строки вне поля не отмечаются).
+ */
+void Snake::MarkRow(int y) noexcept {
+  if (y >= 0 && y < HEIGHT) dirtyRows_ |= 1u << y;
+}
+
+/**
+ * @brief Возвращает строки поля, изменившиеся с предыдущего вызова.
+ *
+ * Строка меняется, если в ней двигалась змейка (включая смену головы) или
+ * яблоко.
+ *
+ * @return uint32_t Бит i - строка i изменилась.
+ */
+uint32_t Snake::TakeDirtyRows() noexcept {
+  uint32_t rows = dirtyRows_;
+  dirtyRows_ = 0;
+  return rows;
 }
 
 /**
@@ -108,6 +211,7 @@ void Snake::GamePaused() noexcept {
  */
 void Snake::GameTerminated() noexcept {
   WriteHighScore();
+  scoreStoreFlush(scoreStore_);
   gameInfo.pause = QUIT;
 }
 
@@ -126,29 +230,18 @@ void Snake::GameStart() noexcept {
  *
  */
 void Snake::ReadHighScore() noexcept {
-  int high_score = 0;
-  FILE *f = fopen(SCORE_FILE_SNAKE, "r");
-  if (f != NULL) {
-    int res = fscanf(f, "%d", &high_score);
-    if (!res) high_score = 0;
-    fclose(f);
-  }
-  gameInfo.high_score = high_score;
+  gameInfo.high_score = scoreStoreRead(scoreStore_);
 }
 
 /**
- * @brief Записывает рекордный счет в файл.
+ * @brief Передает рекордный счет фоновому потоку записи в файл.
  *
- * @param game Указатель на структуру Tetris.
+ * Не дожидается записи: файл обновляется вне игрового цикла.
  */
 void Snake::WriteHighScore() {
   if (gameInfo.score >= gameInfo.high_score) {
     gameInfo.high_score = gameInfo.score;
-    FILE *f = fopen(SCORE_FILE_SNAKE, "w");
-    if (f != NULL) {
-      fprintf(f, "%d", gameInfo.high_score);
-      fclose(f);
-    }
+    scoreStoreSet(scoreStore_, gameInfo.high_score);
   }
 }
 
@@ -225,6 +318,8 @@ void Snake::MoveRight() noexcept {
  *
  */
 void Snake::MovingSnake() noexcept {
+  ALLOC_PHASE(ALLOC_TICK);
+  TRACE_SPAN("Snake::MovingSnake");
   CheckEndGame();
   if (gameInfo.pause != STARTED) {
     return;
@@ -254,12 +349,14 @@ void Snake::MovingSnake() noexcept {
   }
   SnakeElement newCoord{snakeCoordinates.front().x + dx,
                         snakeCoordinates.front().y + dy};
-  auto iter = snakeCoordinates.cbegin();
-  snakeCoordinates.insert(iter, newCoord);
+  MarkRow(snakeCoordinates.front().y);  // прежняя голова становится телом
+  snakeCoordinates.push_front(newCoord);
+  Occupy(newCoord);
   if (CheckEatApple()) {
     GenerateApple();
     WriteHighScore();
   } else {
+    Release(snakeCoordinates.back());
     snakeCoordinates.pop_back();
   }
   flagMoved = true;
@@ -287,16 +384,12 @@ bool Snake::CheckEatApple() noexcept {
 /**
  * @brief Проверка на столкновение змейки с собой
  *
+ * Голова столкнулась с телом, если в ее клетке больше одного сегмента.
  */
 bool Snake::AteSelf() noexcept {
-  bool flag = false;
-  for (size_t i = 1; i < snakeCoordinates.size() && !flag; ++i) {
-    if (snakeCoordinates[i].x == snakeCoordinates[0].x &&
-        snakeCoordinates[i].y == snakeCoordinates[0].y) {
-      flag = true;
-    }
-  }
-  return flag;
+  const SnakeElement &head = snakeCoordinates.front();
+  int index = CellIndex(head.x, head.y);
+  return index >= 0 && occupancy_[index] > 1;
 }
 
 /**
@@ -304,18 +397,15 @@ bool Snake::AteSelf() noexcept {
  *
  */
 void Snake::CheckEndGame() noexcept {
-  for (int i = 0; i < (int)snakeCoordinates.size(); i++) {
-    if (snakeCoordinates.front().x <= 0 && GetDirection() == Left) {
-      gameInfo.pause = LOSED;
-    } else if (snakeCoordinates.front().x >= WIDTH - 1 &&
-               GetDirection() == Right) {
-      gameInfo.pause = LOSED;
-    } else if (snakeCoordinates.front().y <= 0 && GetDirection() == Up) {
-      gameInfo.pause = LOSED;
-    } else if (snakeCoordinates.front().y >= HEIGHT - 1 &&
-               GetDirection() == Down) {
-      gameInfo.pause = LOSED;
-    }
+  const SnakeElement &head = snakeCoordinates.front();
+  if (head.x <= 0 && GetDirection() == Left) {
+    gameInfo.pause = LOSED;
+  } else if (head.x >= WIDTH - 1 && GetDirection() == Right) {
+    gameInfo.pause = LOSED;
+  } else if (head.y <= 0 && GetDirection() == Up) {
+    gameInfo.pause = LOSED;
+  } else if (head.y >= HEIGHT - 1 && GetDirection() == Down) {
+    gameInfo.pause = LOSED;
   }
   if (AteSelf()) {
     gameInfo.pause = LOSED;
@@ -330,33 +420,24 @@ void Snake::CheckEndGame() noexcept {
  *
  */
 bool Snake::IsSnakeBody(int x, int y) noexcept {
-  for (const auto &segment : snakeCoordinates) {
-    if (segment.x == x && segment.y == y) {
-      return true;
-    }
-  }
-  return false;
+  int index = CellIndex(x, y);
+  return index >= 0 && occupancy_[index] > 0;
 }
 
 /**
  * @brief Функция генерации нового яблока
  *
+ * Выбирает равновероятно одну из свободных клеток за O(1).
  */
 void Snake::GenerateApple() noexcept {
-  std::vector<SnakeElement> availablePositions;
-
-  for (int y = 0; y < HEIGHT; y++) {
-    for (int x = 0; x < WIDTH; x++) {
-      if (!IsSnakeBody(x, y)) {
-        availablePositions.push_back({x, y});
-      }
-    }
-  }
-
-  if (!availablePositions.empty()) {
-    int random_index = rand() % availablePositions.size();
-    gameInfo.next[0][0] = availablePositions[random_index].x;
-    gameInfo.next[0][1] = availablePositions[random_index].y;
+  ALLOC_PHASE(ALLOC_SPAWN);
+  TRACE_SPAN("Snake::GenerateApple");
+  if (freeCount_) {
+    int cell = freeCells_[random_() % freeCount_];
+    MarkRow(gameInfo.next[0][1]);
+    MarkRow(cell / WIDTH);
+    gameInfo.next[0][0] = cell % WIDTH;
+    gameInfo.next[0][1] = cell / WIDTH;
   }
 }
 
@@ -380,4 +461,11 @@ void Snake::UpdateLevel() noexcept {
  */
 bool Snake::GetFlagErrorGame() noexcept { return flagError_; }
 
+/**
+ * @brief Получение зерна генератора яблок
+ *
+ * @return uint64_t Зерно, с которым создана игра.
+ */
+uint64_t Snake::GetSeed() const noexcept { return seed_; }
+
 }  // namespace s21
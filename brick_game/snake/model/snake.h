@@ -14,6 +14,7 @@
 
 #include <time.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
@@ -23,6 +24,13 @@
 #include <string>
 #include <vector>
 
+#include "../../common/alloc_stats.h"
+#include "../../common/field.h"
+#include "../../common/frame.h"
+#include "../../common/score_store.h"
+#include "../../common/trace.h"
+#include "ring_buffer.h"
+
 namespace s21 {
 
 /**
@@ -75,14 +83,16 @@ class Snake {
   } SnakeElement;
 
   GameInfo_t gameInfo;  ///< Информация о текущем состоянии игры.
-  std::vector<SnakeElement> snakeCoordinates;  ///< Координаты змейки.
-  struct timespec last_move_time;  ///< время последнего обновления игры
+  /// Координаты змейки от головы к хвосту (меняются только через SetSnake
+  /// и движение змейки).
+  RingBuffer<SnakeElement> snakeCoordinates;
   bool flagMoved;  ///< флаг, указывающий, что змейка переместилась
 
   Snake();
+  explicit Snake(uint64_t seed, const char *scoreFile = SCORE_FILE_SNAKE);
   ~Snake() noexcept;
-  bool CreateField(int ***field, int m, int n);
-  void InitialField(int ***field, int m, int n);
+  bool CreateField(Field_t *field, int m, int n);
+  void InitialField(Field_t *field);
 
   void MoveDown() noexcept;
   void MoveLeft() noexcept;
@@ -110,12 +120,34 @@ class Snake {
   bool CheckEatApple() noexcept;
   bool IsSnakeBody(int x, int y) noexcept;
   void InitialSnake();
+  void SetSnake(const std::vector<SnakeElement> &snake);
 
   bool GetFlagErrorGame() noexcept;
+  uint64_t GetSeed() const noexcept;
+  uint32_t TakeDirtyRows() noexcept;
 
  private:
   UserAction_t direction_;  ///< Направление движения змейки
   bool flagError_;          ///< Флаг успешной работы игры
+  Field_t field_{};  ///< Память игрового поля gameInfo.field
+  Field_t apple_{};  ///< Память координат яблока gameInfo.next
+  uint64_t seed_;    ///< Зерно генератора яблок
+  std::mt19937_64 random_;  ///< Генератор позиций яблок
+  ScoreStore_t *scoreStore_;  ///< Хранилище рекорда (nullptr - без файла)
+  /// Количество сегментов змейки в каждой клетке поля (row-major).
+  std::vector<uint8_t> occupancy_;
+  /// Свободные клетки: первые freeCount_ элементов, порядок произвольный.
+  std::vector<int> freeCells_;
+  /// Позиция клетки в freeCells_ (обратный индекс).
+  std::vector<int> freePosition_;
+  size_t freeCount_;  ///< Количество свободных клеток
+  uint32_t dirtyRows_;  ///< Строки поля, изменившиеся с TakeDirtyRows
+
+  int CellIndex(int x, int y) const noexcept;
+  void Occupy(const SnakeElement &cell) noexcept;
+  void Release(const SnakeElement &cell) noexcept;
+  void SwapFreeCell(int cell, size_t position) noexcept;
+  void MarkRow(int y) noexcept;
 };
 
 }  // namespace s21
@@ -1,154 +1,409 @@
 #include "tetris_backend.h"
 
+#include <unistd.h>
+
 /**
- * @brief Создает игровое поле.
- * @param field Указатель на поле.
- * @param m Количество строк.
- * @param n Количество столбцов.
- * @return int Возвращает OK_, если поле успешно создано, или ERROR при ошибке.
+ * @brief Отмечает строки поля как измененные для gameInfo.field и для
+ * следующего кадра.
+ *
+ * @param board Указатель на битовое поле.
+ * @param rows Маска строк.
  */
-int createField(int ***field, int m, int n) {
-  int flag = OK_;
-  *field = (int **)malloc(sizeof(int *) * m);
-  if (*field == NULL) {
-    flag = ERROR;
-  }
-  if (flag == OK_) {
-    for (int i = 0; i < m; i++) {
-      (*field)[i] = (int *)malloc(sizeof(int) * n);
-      if ((*field)[i] == NULL) {
-        for (int j = 0; j < i; j++) {
-          free((*field)[j]);
-          flag = ERROR;
-        }
-      }
+static void markRows(Board_t *board, uint32_t rows) {
+  board->dirtyRows |= rows;
+  board->frameRows |= rows;
+}
+
+/**
+ * @brief Очищает битовое поле.
+ *
+ * @param board Указатель на битовое поле.
+ */
+void clearBoard(Board_t *board) {
+  memset(board->rows, 0, sizeof(board->rows));
+  memset(board->colors, 0, sizeof(board->colors));
+  board->dirtyRows = ALL_ROWS;
+  board->frameRows = ALL_ROWS;
+}
+
+/**
+ * @brief Устанавливает или очищает клетку битового поля.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @param y Строка клетки.
+ * @param x Столбец клетки.
+ * @param color Цвет клетки (0 - очистить клетку).
+ */
+void setBoardCell(Tetris *game, int y, int x, int color) {
+  if (y >= 0 && y < HEIGHT && x >= 0 && x < WIDTH) {
+    if (color) {
+      game->board.rows[y] |= (uint16_t)(1u << x);
+    } else {
+      game->board.rows[y] &= (uint16_t)~(1u << x);
     }
+    game->board.colors[y][x] = (uint8_t)color;
+    markRows(&game->board, 1u << y);
   }
-  return flag;
 }
 
 /**
- * @brief Инициализирует игровое поле нулями.
+ * @brief Строит представление поля для фронтендов из битового поля.
+ *
+ * В gameInfo.field перестраиваются только строки, изменившиеся с момента
+ * предыдущего вызова, gameInfo.next - только при смене следующей фигуры.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @return GameInfo_t Текущая информация о состоянии игры.
+ */
+GameInfo_t getGameInfo(Tetris *game) {
+  ALLOC_PHASE(ALLOC_RENDER);
+  for (uint32_t rows = game->board.dirtyRows; rows; rows &= rows - 1) {
+    int i = __builtin_ctz(rows);
+    int *cells = game->fieldView.rows[i];
+    for (int j = 0; j < WIDTH; j++) cells[j] = game->board.colors[i][j];
+  }
+  game->board.dirtyRows = 0;
+  if (game->figure.indexShownNext != game->figure.indexNext) {
+    cpyTetraminoFigure(&game->gameInfo.next, game->figure.indexNext);
+    game->figure.indexShownNext = game->figure.indexNext;
+  }
+  return game->gameInfo;
+}
+
+/**
+ * @brief Маска строк поля, которые занимает фигура.
  *
- * @param field Указатель на поле.
- * @param m Количество строк.
- * @param n Количество столбцов.
+ * @param figure Фигура.
+ * @return uint32_t Бит i - фигура видна в строке i.
  */
-void initialField(int ***field, int m, int n) {
-  for (int i = 0; i < m; i++) {
-    for (int j = 0; j < n; j++) {
-      (*field)[i][j] = 0;
-    }
+static uint32_t figureRows(const Figure_t *figure) {
+  const Tetromino_t *t = &TETROMINOS[figure->indexTetramino];
+  uint32_t rows = 0;
+  for (int k = 0; k < 4; k++) {
+    int y = figure->y + t->cells[k][0];
+    if (y >= 0 && y < HEIGHT) rows |= 1u << y;
+  }
+  return rows;
+}
+
+/**
+ * @brief Возвращает изменения с предыдущего кадра и запоминает текущее
+ * состояние как показанное.
+ *
+ * В строки входят измененные строки поля, а если фигура сдвинулась или
+ * повернулась - строки ее прежнего и нового положения.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @return FrameDiff_t Изменившиеся строки поля и значения панели.
+ */
+FrameDiff_t takeFrameDiff(Tetris *game) {
+  ALLOC_PHASE(ALLOC_RENDER);
+  FrameHud_t hud = {game->gameInfo.score, game->gameInfo.high_score,
+                    game->gameInfo.level, game->figure.indexNext,
+                    game->gameInfo.pause};
+  FrameDiff_t diff = {game->board.frameRows,
+                      frameHudDiff(&game->shownHud, &hud)};
+  const Figure_t *shown = &game->shownFigure;
+  if (shown->x != game->figure.x || shown->y != game->figure.y ||
+      shown->indexTetramino != game->figure.indexTetramino) {
+    diff.rows |= figureRows(shown) | figureRows(&game->figure);
   }
+  game->shownFigure = game->figure;
+  game->shownHud = hud;
+  game->board.frameRows = 0;
+  return diff;
 }
 
-static bool TETROMINOS[28][4][4] = {
+#define ROW(a, b, c, d) ((uint16_t)((a) | (b) << 1 | (c) << 2 | (d) << 3))
+
+const Tetromino_t TETROMINOS[TETROMINO_COUNT] = {
     // Фигуры с поворотом на 0°
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {1, 1, 1, 1}},  // I
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 0, 0, 0}, {1, 1, 1, 0}},  // L
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 1, 0}, {1, 1, 1, 0}},  // J
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 1, 0}},  // O
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {1, 1, 0, 0}},  // S
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 0, 0}, {1, 1, 1, 0}},  // T
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 1, 0, 0}, {0, 1, 1, 0}},  // Z
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(1, 1, 1, 1)},
+     0, 3, 3, 3, {{3, 0}, {3, 1}, {3, 2}, {3, 3}}},  // I
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(1, 0, 0, 0), ROW(1, 1, 1, 0)},
+     0, 2, 2, 3, {{2, 0}, {3, 0}, {3, 1}, {3, 2}}},  // L
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 0, 1, 0), ROW(1, 1, 1, 0)},
+     0, 2, 2, 3, {{2, 2}, {3, 0}, {3, 1}, {3, 2}}},  // J
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 1, 1, 0), ROW(0, 1, 1, 0)},
+     1, 2, 2, 3, {{2, 1}, {2, 2}, {3, 1}, {3, 2}}},  // O
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 1, 1, 0), ROW(1, 1, 0, 0)},
+     0, 2, 2, 3, {{2, 1}, {2, 2}, {3, 0}, {3, 1}}},  // S
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 1, 0, 0), ROW(1, 1, 1, 0)},
+     0, 2, 2, 3, {{2, 1}, {3, 0}, {3, 1}, {3, 2}}},  // T
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(1, 1, 0, 0), ROW(0, 1, 1, 0)},
+     0, 2, 2, 3, {{2, 0}, {2, 1}, {3, 1}, {3, 2}}},  // Z
 
     // Фигуры с поворотом на 90°
-    {{0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}},  // I
-    {{0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}},  // L
-    {{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 1, 0}},  // J
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 1, 0}},  // O
-    {{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 1, 0}, {0, 0, 1, 0}},  // S
-    {{0, 0, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}},  // T
-    {{0, 0, 0, 0}, {0, 0, 1, 0}, {0, 1, 1, 0}, {0, 1, 0, 0}},  // Z
+    {{ROW(0, 1, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 0, 0)},
+     1, 1, 0, 3, {{0, 1}, {1, 1}, {2, 1}, {3, 1}}},  // I
+    {{ROW(0, 0, 0, 0), ROW(0, 1, 1, 0), ROW(0, 1, 0, 0), ROW(0, 1, 0, 0)},
+     1, 2, 1, 3, {{1, 1}, {1, 2}, {2, 1}, {3, 1}}},  // L
+    {{ROW(0, 0, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 1, 0)},
+     1, 2, 1, 3, {{1, 1}, {2, 1}, {3, 1}, {3, 2}}},  // J
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 1, 1, 0), ROW(0, 1, 1, 0)},
+     1, 2, 2, 3, {{2, 1}, {2, 2}, {3, 1}, {3, 2}}},  // O
+    {{ROW(0, 0, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 1, 0), ROW(0, 0, 1, 0)},
+     1, 2, 1, 3, {{1, 1}, {2, 1}, {2, 2}, {3, 2}}},  // S
+    {{ROW(0, 0, 0, 0), ROW(1, 0, 0, 0), ROW(1, 1, 0, 0), ROW(1, 0, 0, 0)},
+     0, 1, 1, 3, {{1, 0}, {2, 0}, {2, 1}, {3, 0}}},  // T
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 1, 0), ROW(0, 1, 1, 0), ROW(0, 1, 0, 0)},
+     1, 2, 1, 3, {{1, 2}, {2, 1}, {2, 2}, {3, 1}}},  // Z
 
     // Фигуры с поворотом на 180°
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {1, 1, 1, 1}},  // I
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 1, 1, 0}, {0, 0, 1, 0}},  // L
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 1, 1, 0}, {1, 0, 0, 0}},  // J
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 1, 0}},  // O
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {1, 1, 0, 0}},  // S
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 1, 1, 0}, {0, 1, 0, 0}},  // T
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 1, 0, 0}, {0, 1, 1, 0}},  // Z
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(1, 1, 1, 1)},
+     0, 3, 3, 3, {{3, 0}, {3, 1}, {3, 2}, {3, 3}}},  // I
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(1, 1, 1, 0), ROW(0, 0, 1, 0)},
+     0, 2, 2, 3, {{2, 0}, {2, 1}, {2, 2}, {3, 2}}},  // L
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(1, 1, 1, 0), ROW(1, 0, 0, 0)},
+     0, 2, 2, 3, {{2, 0}, {2, 1}, {2, 2}, {3, 0}}},  // J
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 1, 1, 0), ROW(0, 1, 1, 0)},
+     1, 2, 2, 3, {{2, 1}, {2, 2}, {3, 1}, {3, 2}}},  // O
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 1, 1, 0), ROW(1, 1, 0, 0)},
+     0, 2, 2, 3, {{2, 1}, {2, 2}, {3, 0}, {3, 1}}},  // S
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(1, 1, 1, 0), ROW(0, 1, 0, 0)},
+     0, 2, 2, 3, {{2, 0}, {2, 1}, {2, 2}, {3, 1}}},  // T
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(1, 1, 0, 0), ROW(0, 1, 1, 0)},
+     0, 2, 2, 3, {{2, 0}, {2, 1}, {3, 1}, {3, 2}}},  // Z
 
     // Фигуры с поворотом на 270°
-    {{0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}},  // I
-    {{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}, {1, 1, 0, 0}},  // L
-    {{0, 0, 0, 0}, {1, 1, 0, 0}, {0, 1, 0, 0}, {0, 1, 0, 0}},  // J
-    {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 1, 1, 0}, {0, 1, 1, 0}},  // O
-    {{0, 0, 0, 0}, {0, 1, 0, 0}, {0, 1, 1, 0}, {0, 0, 1, 0}},  // S
-    {{0, 0, 0, 0}, {0, 0, 1, 0}, {0, 1, 1, 0}, {0, 0, 1, 0}},  // T
-    {{0, 0, 0, 0}, {0, 0, 1, 0}, {0, 1, 1, 0}, {0, 1, 0, 0}}   // Z
+    {{ROW(0, 1, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 0, 0)},
+     1, 1, 0, 3, {{0, 1}, {1, 1}, {2, 1}, {3, 1}}},  // I
+    {{ROW(0, 0, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 0, 0), ROW(1, 1, 0, 0)},
+     0, 1, 1, 3, {{1, 1}, {2, 1}, {3, 0}, {3, 1}}},  // L
+    {{ROW(0, 0, 0, 0), ROW(1, 1, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 0, 0)},
+     0, 1, 1, 3, {{1, 0}, {1, 1}, {2, 1}, {3, 1}}},  // J
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 0, 0), ROW(0, 1, 1, 0), ROW(0, 1, 1, 0)},
+     1, 2, 2, 3, {{2, 1}, {2, 2}, {3, 1}, {3, 2}}},  // O
+    {{ROW(0, 0, 0, 0), ROW(0, 1, 0, 0), ROW(0, 1, 1, 0), ROW(0, 0, 1, 0)},
+     1, 2, 1, 3, {{1, 1}, {2, 1}, {2, 2}, {3, 2}}},  // S
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 1, 0), ROW(0, 1, 1, 0), ROW(0, 0, 1, 0)},
+     1, 2, 1, 3, {{1, 2}, {2, 1}, {2, 2}, {3, 2}}},  // T
+    {{ROW(0, 0, 0, 0), ROW(0, 0, 1, 0), ROW(0, 1, 1, 0), ROW(0, 1, 0, 0)},
+     1, 2, 1, 3, {{1, 2}, {2, 1}, {2, 2}, {3, 1}}},  // Z
 };
 
+#undef ROW
+
+/**
+ * @brief Задает начальное состояние генератора случайных чисел игры.
+ *
+ * Состояние получается из зерна через splitmix64, поэтому любое зерно,
+ * включая 0, дает ненулевое состояние xorshift.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @param seed Зерно генератора.
+ */
+void seedGame(Tetris *game, uint64_t seed) {
+  uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  z ^= z >> 31;
+  game->seed = seed;
+  game->rngState = z ? z : 0x9E3779B97F4A7C15ull;
+}
+
+/**
+ * @brief Начинает запись партии: все последующие вызовы userInput и
+ * updateCurrentState попадают в replay.
+ *
+ * Запись принадлежит вызывающей стороне и должна жить, пока игра пишет в
+ * нее. По записи и зерну партия воспроизводится без интерфейса.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @param replay Запись партии.
+ */
+void recordReplay(Tetris *game, Replay_t *replay) {
+  replayInit(replay, REPLAY_TETRIS, game->seed);
+  game->replay = replay;
+}
+
+/**
+ * @brief Возвращает следующее число генератора xorshift64* игры.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @return uint64_t Псевдослучайное число.
+ */
+static uint64_t nextRandom(Tetris *game) {
+  uint64_t x = game->rngState;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  game->rngState = x;
+  return x * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * @brief Выбирает тип следующей фигуры равновероятно.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @return int Тип фигуры от 0 до TETROMINO_TYPES - 1.
+ */
+static int randomPiece(Tetris *game) {
+  return (int)(((nextRandom(game) >> 32) * TETROMINO_TYPES) >> 32);
+}
+
+/**
+ * @brief Обновляет рекорд в памяти и сообщает о нем обработчику сохранения.
+ *
+ * @param game Указатель на структуру Tetris.
+ */
+static void updateHighScore(Tetris *game) {
+  if (game->gameInfo.score > game->gameInfo.high_score) {
+    game->gameInfo.high_score = game->gameInfo.score;
+    if (game->saveHighScore) game->saveHighScore(game);
+  }
+}
+
 /**
  * @brief Инициализирует фигуру для игры.
  *
  * @param game Указатель на структуру Tetris.
  */
 void initializeFigure(Tetris *game) {
+  ALLOC_PHASE(ALLOC_SPAWN);
   attachingFigures(game);
   game->figure.indexTetramino = game->figure.indexNext;
-  for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 4; j++) {
-      game->figure.shape[i][j] = game->gameInfo.next[i][j];
-    }
-  }
-  int randomIndex = rand() % 10 * (rand() % 10) % 7;
-
-  cpyTetraminoFigure(&game->gameInfo.next, randomIndex);
-  game->figure.indexNext = randomIndex;
+  game->figure.indexNext = randomPiece(game);
   game->figure.x = WIDTH / 2 - 2;
   game->figure.y = -3;
 }
 
+/**
+ * @brief Случайное зерно новой игры.
+ *
+ * Смешивает время в наносекундах, номер процесса и номер вызова: игры,
+ * начатые в одну секунду (быстрый перезапуск, несколько окон или
+ * процессов), получают разные зерна.
+ *
+ * @return uint64_t Зерно.
+ */
+static uint64_t randomSeed(void) {
+  static uint64_t calls;
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  uint64_t seed = (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+  seed ^= (uint64_t)getpid() << 40;
+  return seed + __atomic_add_fetch(&calls, 1, __ATOMIC_RELAXED) *
+                    0x9E3779B97F4A7C15ull;
+}
+
+/**
+ * @brief Инициализирует игру со случайным зерном.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @return int Возвращает OK_ при успешной инициализации, иначе ERROR.
+ */
+int initialGame(Tetris *game) { return initialGameSeeded(game, randomSeed()); }
+
 /**
  * @brief Инициализирует игру, создавая поле и фигуры, задает начальные
  * параметры.
  *
+ * Последовательность фигур определяется только зерном: одинаковое зерно и
+ * одинаковый ввод дают одинаковую игру. Рекорд не загружается, ядро не
+ * работает с файлами (см. attachHighScoreFile).
+ *
  * @param game Указатель на структуру Tetris.
+ * @param seed Зерно генератора фигур.
  * @return int Возвращает OK_ при успешной инициализации, иначе ERROR.
  */
-int initialGame(Tetris *game) {
+int initialGameSeeded(Tetris *game, uint64_t seed) {
   game->gameInfo.level = 1;
   game->gameInfo.score = 0;
+  game->gameInfo.high_score = 0;
   game->gameInfo.pause = NOT_STARTED;
+  game->saveHighScore = NULL;
+  game->flushHighScore = NULL;
+  game->replay = NULL;
+  seedGame(game, seed);
   updateLevel(game);
-  readHighScore(game);
   game->speed = 1;
   int flag = OK_;
-  flag = createField(&(game->gameInfo.field), HEIGHT, WIDTH);
-  if (flag == OK_) flag = createField(&(game->gameInfo.next), 4, 4);
-  if (flag == OK_) flag = createField(&(game->figure.shape), 4, 4);
+  if (!fieldCreate(&game->fieldView, HEIGHT, WIDTH)) {
+    flag = ERROR;
+  } else if (!fieldCreate(&game->nextView, 4, 4)) {
+    fieldDestroy(&game->fieldView);
+    flag = ERROR;
+  }
 
   if (flag == OK_) {
-    initialField(&game->gameInfo.field, HEIGHT, WIDTH);
-    int randomIndex = rand() % 10 * (rand() % 10) % 7;
-
-    for (int i = 0; i < 4; i++) {
-      for (int j = 0; j < 4; j++) {
-        game->gameInfo.next[i][j] = TETROMINOS[randomIndex][i][j];
-      }
-    }
-    game->figure.indexNext = randomIndex;
+    game->clearedRows = 0;
+    game->lines = 0;
+    game->pieces = 0;
+    game->gameInfo.field = game->fieldView.rows;
+    game->gameInfo.next = game->nextView.rows;
+    clearBoard(&game->board);
+    game->figure.indexNext = randomPiece(game);
+    game->figure.indexShownNext = -1;
     initializeFigure(game);
     game->figure.y = -2;
+    game->shownFigure = game->figure;
+    memset(&game->shownHud, 0, sizeof(game->shownHud));
+    game->shownHud.state = -1;
   }
 
   return flag;
 }
 
 /**
- * @brief Обновляет текущее состояние игры, двигая фигуру вниз.
+ * @brief Выполняет один шаг гравитации.
  *
  * @param game Указатель на структуру Tetris.
- * @return GameInfo_t Текущая информация о состоянии игры.
  */
-GameInfo_t updateCurrentState(Tetris *game) {
+static void gravityStep(Tetris *game) {
   if (game->gameInfo.pause == STARTED) {
     checkLockFigure(game);
     moveDown(game);
   }
-  return game->gameInfo;
+}
+
+/**
+ * @brief Обновляет текущее состояние игры, двигая фигуру вниз.
+ *
+ * Вызов считается тактом гравитации и отмечается в записи партии.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @return GameInfo_t Текущая информация о состоянии игры.
+ */
+GameInfo_t updateCurrentState(Tetris *game) {
+  ALLOC_PHASE(ALLOC_TICK);
+  TRACE_SPAN("updateCurrentState");
+  if (game->replay) replayTick(game->replay);
+  gravityStep(game);
+  return getGameInfo(game);
+}
+
+/**
+ * @brief Переносит маску строки фигуры в координаты строки поля.
+ *
+ * Вызывающая сторона проверяет, что фигура помещается по ширине, поэтому
+ * при сдвиге вправо занятые биты не теряются.
+ *
+ * @param shapeRow Маска строки фигуры.
+ * @param x Позиция фигуры по оси X.
+ * @return uint16_t Маска строки поля.
+ */
+static uint16_t shiftRow(uint16_t shapeRow, int x) {
+  return (uint16_t)(x >= 0 ? shapeRow << x : shapeRow >> -x);
+}
+
+/**
+ * @brief Проверяет, опирается ли фигура на дно или закрепленные клетки.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @param onFloor Устанавливается в true, если фигура стоит на дне поля.
+ * @return true Если фигура не может опуститься ниже.
+ */
+static bool isFigureResting(const Tetris *game, bool *onFloor) {
+  const Tetromino_t *t = &TETROMINOS[game->figure.indexTetramino];
+  int y = game->figure.y;
+  bool resting = *onFloor = y + t->maxY >= HEIGHT - 1;
+  for (int i = t->maxY; i >= t->minY && !resting; i--) {
+    int below = y + i + 1;
+    resting = below >= 0 && (game->board.rows[below] &
+                             shiftRow(t->rows[i], game->figure.x));
+  }
+  return resting;
 }
 
 /**
@@ -164,21 +419,12 @@ void moveDown(Tetris *game) { game->figure.y++; }
  * @param game Указатель на структуру Tetris.
  */
 void checkLockFigure(Tetris *game) {
-  for (int i = 3; i >= 0; i--) {
-    for (int j = 3; j >= 0; j--) {
-      int ptr = game->figure.shape[i][j];
-      if (game->figure.y + i == HEIGHT - 1) {
-        lockFigure(game);
-
-      } else if (ptr == 1 && game->figure.y + i + 1 >= 0 &&
-                 (game->gameInfo.field[game->figure.y + i + 1]
-                                      [game->figure.x + j] != 0)) {
-        if (checkLose(game)) {
-          game->gameInfo.pause = ENDED;
-        } else {
-          lockFigure(game);
-        }
-      }
+  bool onFloor = false;
+  while (game->gameInfo.pause != ENDED && isFigureResting(game, &onFloor)) {
+    if (!onFloor && checkLose(game)) {
+      game->gameInfo.pause = ENDED;
+    } else {
+      lockFigure(game);
     }
   }
 }
@@ -189,15 +435,18 @@ void checkLockFigure(Tetris *game) {
  * @param game Указатель на структуру Tetris.
  */
 void lockFigure(Tetris *game) {
-  for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 4; j++) {
-      if (game->figure.shape[i][j] == 1 && game->figure.y + i >= 0 &&
-          !game->gameInfo.field[game->figure.y + i][game->figure.x + j]) {
-        game->gameInfo.field[game->figure.y + i][game->figure.x + j] =
-            game->figure.indexTetramino % 7 + 1;
-      }
+  const Tetromino_t *t = &TETROMINOS[game->figure.indexTetramino];
+  uint8_t color = (uint8_t)(PIECE_TYPE(game->figure.indexTetramino) + 1);
+  for (int k = 0; k < 4; k++) {
+    int y = game->figure.y + t->cells[k][0];
+    int x = game->figure.x + t->cells[k][1];
+    if (y >= 0 && !(game->board.rows[y] & (1u << x))) {
+      game->board.rows[y] |= (uint16_t)(1u << x);
+      game->board.colors[y][x] = color;
+      markRows(&game->board, 1u << y);
     }
   }
+  game->pieces++;
   initializeFigure(game);
 }
 
@@ -211,19 +460,15 @@ void lockFigure(Tetris *game) {
  * @return false Если позиция невалидна.
  */
 bool isValidPosition(Tetris *game, int diffX, int diifY) {
-  for (int y = 0; y < 4; y++) {
-    for (int x = 0; x < 4; x++) {
-      if (game->figure.shape[y][x]) {
-        int newX = game->figure.x + x + diffX;
-        int newY = game->figure.y + y + diifY;
-        if (newX < 0 || newX >= WIDTH || newY < 0 || newY >= HEIGHT ||
-            game->gameInfo.field[newY][newX]) {
-          return false;
-        }
-      }
-    }
+  const Tetromino_t *t = &TETROMINOS[game->figure.indexTetramino];
+  int x = game->figure.x + diffX;
+  int y = game->figure.y + diifY;
+  bool valid = x + t->minX >= 0 && x + t->maxX < WIDTH && y + t->minY >= 0 &&
+               y + t->maxY < HEIGHT;
+  for (int i = t->minY; i <= t->maxY && valid; i++) {
+    valid = !(game->board.rows[y + i] & shiftRow(t->rows[i], x));
   }
-  return true;
+  return valid;
 }
 
 /**
@@ -252,7 +497,6 @@ void moveRight(Tetris *game) {
 void rotate(Tetris *game) {
   if (checkRotate(game)) {
     game->figure.indexTetramino = (game->figure.indexTetramino + 7) % 28;
-    cpyTetraminoFigure(&game->figure.shape, game->figure.indexTetramino);
   }
 }
 
@@ -260,32 +504,32 @@ void rotate(Tetris *game) {
  * @brief Проверяет возможность поворота фигуры.
  *
  * @param game Указатель на структуру Tetris.
- * @return int Возвращает TRUE, если поворот возможен, иначе FALSE.
- */
-int checkRotate(Tetris *game) {
-  int **tmp;
-  int flag = createField(&tmp, 4, 4);
-  if (flag != ERROR) {
-    flag = TRUE;
-    cpyTetraminoFigure(&tmp, (game->figure.indexTetramino + 7) % 28);
-    for (int i = 0; i < 4; i++) {
-      for (int j = 0; j < 4; j++) {
-        if (tmp[i][j] &&
-            (game->figure.x + j >= WIDTH || game->figure.x + j <= -1 ||
-             game->figure.y + i >= HEIGHT)) {
-          flag = FALSE;
-        } else if (game->figure.y + i >= 0 && tmp[i][j] &&
-                   game->gameInfo
-                       .field[game->figure.y + i][game->figure.x + j]) {
-          flag = FALSE;
-        }
-      }
-    }
+ * @return int Возвращает 1, если поворот возможен, иначе 0.
+ */
+int checkRotate(Tetris *game) { return canRotate(game, 1); }
 
-    for (int i = 0; i < 4; i++) free(tmp[i]);
-    free(tmp);
+/**
+ * @brief Проверяет возможность поворота фигуры без изменения игры.
+ *
+ * Целевой поворот проверяется по маскам таблицы TETROMINOS напрямую на
+ * битовом поле, без выделения памяти. Клетки выше поля допускаются.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @param dir Направление поворота: 1 - по часовой стрелке, -1 - против.
+ * @return true Если фигуру можно повернуть на месте.
+ */
+bool canRotate(const Tetris *game, int dir) {
+  int index = game->figure.indexTetramino;
+  int rotation = (PIECE_ROTATION(index) + dir % 4 + 4) % 4;
+  const Tetromino_t *t = &TETROMINOS[PIECE_INDEX(PIECE_TYPE(index), rotation)];
+  int x = game->figure.x;
+  int y = game->figure.y;
+  bool valid =
+      x + t->minX >= 0 && x + t->maxX < WIDTH && y + t->maxY < HEIGHT;
+  for (int i = t->minY; i <= t->maxY && valid; i++) {
+    valid = y + i < 0 || !(game->board.rows[y + i] & shiftRow(t->rows[i], x));
   }
-  return flag;
+  return valid;
 }
 
 /**
@@ -316,33 +560,43 @@ void changeScore(Tetris *game, int counter) {
 /**
  * @brief Удаляет заполненные строки и "подтягивает" строки вниз.
  *
+ * Все заполненные строки удаляются за один проход снизу вверх: каждая
+ * оставшаяся строка копируется не более одного раза. Маска удаленных строк
+ * сохраняется в game->clearedRows.
+ *
  * @param game Указатель на структуру Tetris.
+ * @return uint32_t Маска удаленных строк: бит i - строка i до удаления.
  */
-void attachingFigures(Tetris *game) {
-  int counter = 0;
-  for (int i = 0; i < HEIGHT; i++) {
-    int sum = 0;
-    for (int j = 0; j < WIDTH; j++) {
-      if (game->gameInfo.field[i][j]) {
-        sum++;
-      }
-    }
-    if (sum == 10) {
-      counter++;
-      for (int j = 0; j < WIDTH; j++) {
-        game->gameInfo.field[i][j] = 0;
-      }
-      for (int k = i - 1; k >= 0; k--) {
-        for (int j = 0; j < WIDTH; j++) {
-          game->gameInfo.field[k + 1][j] = game->gameInfo.field[k][j];
-        }
+uint32_t attachingFigures(Tetris *game) {
+  TRACE_SPAN("attachingFigures");
+  Board_t *board = &game->board;
+  uint32_t cleared = 0;
+  int target = HEIGHT - 1;
+  for (int i = HEIGHT - 1; i >= 0; i--) {
+    if (board->rows[i] == FULL_ROW) {
+      cleared |= 1u << i;
+    } else {
+      if (target != i) {
+        board->rows[target] = board->rows[i];
+        memcpy(board->colors[target], board->colors[i], WIDTH);
       }
+      target--;
     }
   }
+  if (cleared) {
+    memset(board->rows, 0, sizeof(board->rows[0]) * (target + 1));
+    memset(board->colors, 0, sizeof(board->colors[0]) * (target + 1));
+    // Строки выше самой нижней удаленной сдвинулись.
+    markRows(board, FRAME_ROWS(31 - __builtin_clz(cleared) + 1));
+  }
+  int counter = __builtin_popcount(cleared);
+  game->clearedRows = cleared;
+  game->lines += counter;
 
   changeScore(game, counter);
-  writeHighScore(game);
+  updateHighScore(game);
   updateLevel(game);
+  return cleared;
 }
 
 /**
@@ -354,7 +608,7 @@ void attachingFigures(Tetris *game) {
 void cpyTetraminoFigure(int ***field, int indexTetramino) {
   for (int i = 0; i < 4; i++) {
     for (int j = 0; j < 4; j++) {
-      (*field)[i][j] = TETROMINOS[indexTetramino][i][j];
+      (*field)[i][j] = (TETROMINOS[indexTetramino].rows[i] >> j) & 1;
     }
   }
 }
@@ -370,6 +624,19 @@ void updateLevel(Tetris *game) {
   game->speed = game->gameInfo.level;
 }
 
+/**
+ * @brief Возвращает период гравитации для текущей скорости.
+ *
+ * Фронтенды передают его планировщику тактов (CommonTick): один такт -
+ * один вызов updateCurrentState.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @return int64_t Длительность такта в наносекундах.
+ */
+int64_t gravityPeriodNs(const Tetris *game) {
+  return GRAVITY_BASE_NS - (int64_t)(game->speed * GRAVITY_STEP_NS);
+}
+
 /**
  * @brief Приостанавливает или возобновляет игру.
  *
@@ -387,15 +654,7 @@ void gamePaused(Tetris *game) {
  * @return true Если игра окончена.
  * @return false Если игра продолжается.
  */
-bool checkLose(Tetris *game) {
-  bool flagEnd = false;
-  for (int i = 0; i < WIDTH; i++) {
-    if (game->gameInfo.field[0][i]) {
-      flagEnd = true;
-    }
-  }
-  return flagEnd;
-}
+bool checkLose(Tetris *game) { return game->board.rows[0] != 0; }
 
 /**
  * @brief Завершает игру, сохраняя рекорд.
@@ -403,7 +662,8 @@ bool checkLose(Tetris *game) {
  * @param game Указатель на структуру Tetris.
  */
 void gameTerminated(Tetris *game) {
-  writeHighScore(game);
+  updateHighScore(game);
+  if (game->flushHighScore) game->flushHighScore(game);
   game->gameInfo.pause = QUIT;
 }
 
@@ -428,7 +688,9 @@ void gameStart(Tetris *game) {
  * @param hold Удержание клавиши.
  */
 void userInput(Tetris *game, UserAction_t action, bool hold) {
-  (void)hold;
+  ALLOC_PHASE(ALLOC_INPUT);
+  TRACE_SPAN("userInput");
+  if (game->replay) replayInput(game->replay, action, hold);
   if (game->gameInfo.pause == STARTED) {
     switch (action) {
       case Left:
@@ -438,7 +700,7 @@ void userInput(Tetris *game, UserAction_t action, bool hold) {
         moveRight(game);
         break;
       case Down:
-        updateCurrentState(game);
+        gravityStep(game);
         break;
       case Action:
         rotate(game);
@@ -463,52 +725,14 @@ void userInput(Tetris *game, UserAction_t action, bool hold) {
   }
 }
 
-/**
- * @brief Считывает рекордный счет из файла.
- *
- * @param game Указатель на структуру Tetris.
- */
-void readHighScore(Tetris *game) {
-  FILE *f = fopen(SCORE_FILE, "r");
-  if (f != NULL) {
-    char line[255];
-    fgets(line, 255, f);
-    int s;
-    sscanf(line, "%d", &s);
-    game->gameInfo.high_score = s;
-    fclose(f);
-
-  } else {
-    game->gameInfo.high_score = 0;
-  }
-}
-
-/**
- * @brief Записывает рекордный счет в файл.
- *
- * @param game Указатель на структуру Tetris.
- */
-void writeHighScore(Tetris *game) {
-  if (game->gameInfo.score >= game->gameInfo.high_score) {
-    game->gameInfo.high_score = game->gameInfo.score;
-    FILE *f = fopen(SCORE_FILE, "w");
-    if (f != NULL) {
-      fprintf(f, "%d", game->gameInfo.high_score);
-      fclose(f);
-    }
-  }
-}
-
 /**
  * @brief Освобождает память, выделенную для игрового поля и фигур.
  *
  * @param game Указатель на структуру Tetris.
  */
 void freeSpace(Tetris *game) {
-  for (int i = 0; i < 4; i++) free(game->figure.shape[i]);
-  free(game->figure.shape);
-  for (int i = 0; i < 4; i++) free(game->gameInfo.next[i]);
-  free(game->gameInfo.next);
-  for (int i = 0; i < HEIGHT; i++) free(game->gameInfo.field[i]);
-  free(game->gameInfo.field);
+  fieldDestroy(&game->nextView);
+  fieldDestroy(&game->fieldView);
+  game->gameInfo.field = NULL;
+  game->gameInfo.next = NULL;
 }
@@ -10,15 +10,27 @@
 #define ENDED 3
 #define QUIT 4
 #define timet 30
-#define SCORE_FILE "TetrisHighScore.txt"
+#define GRAVITY_BASE_NS 1550000000LL
+#define GRAVITY_STEP_NS 125000000LL
+#define FULL_ROW ((uint16_t)((1u << WIDTH) - 1))
+#define ALL_ROWS FRAME_ROWS(HEIGHT)
+#define TETROMINO_TYPES 7
+#define TETROMINO_COUNT 28
+#define PIECE_TYPE(index) ((index) % TETROMINO_TYPES)
+#define PIECE_ROTATION(index) ((index) / TETROMINO_TYPES)
+#define PIECE_INDEX(type, rotation) ((rotation) * TETROMINO_TYPES + (type))
 
-#include <ncurses.h>
 #include <stdbool.h>
-#include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <unistd.h>
+
+#include "../common/alloc_stats.h"
+#include "../common/field.h"
+#include "../common/frame.h"
+#include "../common/replay.h"
+#include "../common/trace.h"
 
 /**
  * @defgroup TetrisGame Tetris Game
@@ -54,28 +66,80 @@ typedef struct {
   int pause;  ///< Статус паузы (Принимает значение от 0 до 4).
 } GameInfo_t;
 
+/**
+ * @brief Предвычисленное описание одного поворота тетромино в блоке 4x4.
+ * @ingroup TetrisGame
+ */
+typedef struct {
+  uint16_t rows[4];  ///< Маски строк: бит j установлен, если занят столбец j.
+  int8_t minX;       ///< Левый столбец ограничивающего прямоугольника.
+  int8_t maxX;       ///< Правый столбец ограничивающего прямоугольника.
+  int8_t minY;       ///< Верхняя строка ограничивающего прямоугольника.
+  int8_t maxY;       ///< Нижняя строка ограничивающего прямоугольника.
+  int8_t cells[4][2];  ///< Смещения клеток фигуры {y, x}.
+} Tetromino_t;
+
+/**
+ * @brief Таблица всех тетромино: индекс PIECE_INDEX(тип, поворот).
+ * @ingroup TetrisGame
+ */
+extern const Tetromino_t TETROMINOS[TETROMINO_COUNT];
+
 /**
  * @brief Структура, описывающая текущую фигуру на игровом поле.
+ *
+ * Форма фигуры не копируется: фигура ссылается на строку таблицы TETROMINOS
+ * по индексу PIECE_INDEX(тип, поворот).
  * @ingroup TetrisGame
  */
 typedef struct {
-  int x;        ///< Позиция фигуры по оси X.
-  int y;        ///< Позиция фигуры по оси Y.
-  int **shape;  ///< Форма фигуры (двумерный массив).
-  int indexTetramino;  ///< Индекс текущей фигуры (тетромино).
-  int indexNext;  ///< Индекс следующей фигуры.
+  int x;  ///< Позиция фигуры по оси X.
+  int y;  ///< Позиция фигуры по оси Y.
+  int indexTetramino;  ///< Индекс текущей фигуры (тип и поворот).
+  int indexNext;       ///< Индекс следующей фигуры.
+  int indexShownNext;  ///< Индекс фигуры, построенной в gameInfo.next.
 } Figure_t;
 
+/**
+ * @brief Битовое представление игрового поля.
+ *
+ * Каждая строка поля хранится в одном 16-битном слове: бит j установлен, если
+ * клетка (i, j) занята. Цвета закрепленных клеток лежат в отдельной компактной
+ * плоскости, которая нужна только для отрисовки.
+ * @ingroup TetrisGame
+ */
+typedef struct {
+  uint16_t rows[HEIGHT];          ///< Маски занятых клеток по строкам.
+  uint8_t colors[HEIGHT][WIDTH];  ///< Цвета закрепленных клеток (0 - пусто).
+  uint32_t dirtyRows;  ///< Строки, измененные после построения gameInfo.field.
+  uint32_t frameRows;  ///< Строки, измененные после takeFrameDiff.
+} Board_t;
+
 /**
  * @brief Главная структура игры Tetris, содержащая информацию об игре и
  * фигурах.
  * @ingroup TetrisGame
  */
-typedef struct {
-  GameInfo_t gameInfo;  ///< Информация о текущем состоянии игры.
-  Figure_t figure;  ///< Текущая фигура.
-  double speed;     ///< Текущая скорость игры.
-  bool flag;  ///< Флаг, используемый для управления игровым процессом.
+typedef struct Tetris {
+  GameInfo_t gameInfo;   ///< Информация о текущем состоянии игры.
+  Board_t board;         ///< Битовое игровое поле.
+  Field_t fieldView;     ///< Память представления gameInfo.field.
+  Field_t nextView;      ///< Память представления gameInfo.next.
+  Figure_t figure;       ///< Текущая фигура.
+  Figure_t shownFigure;  ///< Фигура в последнем кадре (takeFrameDiff).
+  FrameHud_t shownHud;   ///< Панель в последнем кадре (takeFrameDiff).
+  uint32_t clearedRows;  ///< Маска строк, удаленных последним закреплением.
+  uint32_t lines;        ///< Всего удаленных строк за игру.
+  uint32_t pieces;       ///< Всего закрепленных фигур за игру.
+  uint64_t seed;         ///< Зерно, с которым начата игра.
+  uint64_t rngState;     ///< Состояние генератора фигур xorshift64*.
+  Replay_t *replay;      ///< Запись партии (NULL - партия не записывается).
+  /// Обработчик сохранения рекорда (NULL - рекорд хранится только в памяти).
+  void (*saveHighScore)(struct Tetris *game);
+  /// Обработчик завершения сохранения в конце игры (NULL - не нужен).
+  void (*flushHighScore)(struct Tetris *game);
+  double speed;  ///< Текущая скорость игры.
+  bool flag;     ///< Флаг, используемый для управления игровым процессом.
 } Tetris;
 
 /**
@@ -88,11 +152,16 @@ void userInput(Tetris *game, UserAction_t action,
                bool hold);  // overrided from readme
 
 GameInfo_t updateCurrentState(Tetris *game);
+GameInfo_t getGameInfo(Tetris *game);
+FrameDiff_t takeFrameDiff(Tetris *game);
 
-int createField(int ***field, int m, int n);
-void initialField(int ***field, int m, int n);
+void clearBoard(Board_t *board);
+void setBoardCell(Tetris *game, int y, int x, int color);
 void initializeFigure(Tetris *game);
 int initialGame(Tetris *game);
+int initialGameSeeded(Tetris *game, uint64_t seed);
+void seedGame(Tetris *game, uint64_t seed);
+void recordReplay(Tetris *game, Replay_t *replay);
 
 void checkLockFigure(Tetris *game);
 void lockFigure(Tetris *game);
@@ -102,16 +171,16 @@ void moveLeft(Tetris *game);
 void moveRight(Tetris *game);
 void rotate(Tetris *game);
 int checkRotate(Tetris *game);
+bool canRotate(const Tetris *game, int dir);
 
 void cpyTetraminoFigure(int ***field, int indexTetramino);
 
-void attachingFigures(Tetris *game);
+uint32_t attachingFigures(Tetris *game);
 bool checkLose(Tetris *game);
 void changeScore(Tetris *game, int counter);
 void updateLevel(Tetris *game);
+int64_t gravityPeriodNs(const Tetris *game);
 
-void readHighScore(Tetris *game);
-void writeHighScore(Tetris *game);
 bool isValidPosition(Tetris *game, int diffX, int diifY);
 
 void gamePaused(Tetris *game);
@@ -0,0 +1,319 @@
+#include "tetris_batch.h"
+
+/**
+ * @brief Состояние стратегии бота.
+ */
+typedef struct {
+  TetrisBot_t bot;     ///< Бот без дополнительных потоков.
+  Placement_t target;  ///< Текущая цель.
+  uint32_t pieces;     ///< Номер фигуры, для которой найдена цель.
+  bool planned;        ///< Цель найдена.
+} BotPolicy_t;
+
+/**
+ * @brief Создает состояние случайной стратегии.
+ *
+ * @return void* Состояние генератора xorshift64.
+ */
+static void *randomCreate(void) {
+  return calloc(1, sizeof(uint64_t));
+}
+
+/**
+ * @brief Засевает генератор случайной стратегии зерном партии.
+ */
+static void randomNewGame(void *state, uint64_t seed) {
+  *(uint64_t *)state = seed * 0x9E3779B97F4A7C15ull | 1;
+}
+
+/**
+ * @brief Выбирает случайное действие, включая бездействие (Up).
+ */
+static UserAction_t randomNext(void *state, const Tetris *game) {
+  static const UserAction_t actions[] = {Left, Right, Down, Action, Up};
+  uint64_t *x = (uint64_t *)state;
+  (void)game;
+  *x ^= *x << 13;
+  *x ^= *x >> 7;
+  *x ^= *x << 17;
+  return actions[*x % (sizeof(actions) / sizeof(actions[0]))];
+}
+
+/**
+ * @brief Не вмешивается в игру: фигуры падают только под действием
+ * гравитации.
+ */
+static UserAction_t idleNext(void *state, const Tetris *game) {
+  (void)state;
+  (void)game;
+  return Up;
+}
+
+/**
+ * @brief Создает состояние стратегии бота.
+ *
+ * Бот работает без пула потоков: параллельность дают партии.
+ */
+static void *botPolicyCreate(void) {
+  BotPolicy_t *state = (BotPolicy_t *)malloc(sizeof(BotPolicy_t));
+  if (state && botCreate(&state->bot, 1, botDefaultWeights()) != OK_) {
+    free(state);
+    state = NULL;
+  }
+  return state;
+}
+
+/**
+ * @brief Сбрасывает цель бота перед новой партией.
+ */
+static void botPolicyNewGame(void *state, uint64_t seed) {
+  (void)seed;
+  ((BotPolicy_t *)state)->planned = false;
+}
+
+/**
+ * @brief Ищет цель для каждой новой фигуры и ведет фигуру к ней.
+ */
+static UserAction_t botPolicyNext(void *state, const Tetris *game) {
+  BotPolicy_t *policy = (BotPolicy_t *)state;
+  if (!policy->planned || policy->pieces != game->pieces) {
+    policy->planned =
+        botFindPlacement(&policy->bot, game, true, &policy->target);
+    policy->pieces = game->pieces;
+  }
+  return policy->planned ? botNextAction(game, &policy->target) : Down;
+}
+
+/**
+ * @brief Освобождает состояние стратегии бота.
+ */
+static void botPolicyDestroy(void *state) {
+  botDestroy(&((BotPolicy_t *)state)->bot);
+  free(state);
+}
+
+static const TetrisPolicy_t POLICIES[] = {
+    {"bot", botPolicyCreate, botPolicyNewGame, botPolicyNext,
+     botPolicyDestroy},
+    {"random", randomCreate, randomNewGame, randomNext, free},
+    {"idle", NULL, NULL, idleNext, NULL},
+};
+
+/**
+ * @brief Ищет стратегию по имени.
+ *
+ * @param name Имя стратегии.
+ * @return const TetrisPolicy_t* Стратегия или NULL, если имя неизвестно.
+ */
+const TetrisPolicy_t *findPolicy(const char *name) {
+  const TetrisPolicy_t *policy = NULL;
+  for (size_t i = 0; i < sizeof(POLICIES) / sizeof(POLICIES[0]) && !policy;
+       i++) {
+    if (!strcmp(POLICIES[i].name, name)) policy = &POLICIES[i];
+  }
+  return policy;
+}
+
+/**
+ * @brief Играет одну партию: на каждом такте действие стратегии и шаг
+ * гравитации.
+ *
+ * @param policy Стратегия.
+ * @param state Состояние стратегии.
+ * @param seed Зерно партии.
+ * @param maxTicks Предел тактов.
+ * @param result Результат партии.
+ * @return int OK_ при успехе, иначе ERROR.
+ */
+int runGame(const TetrisPolicy_t *policy, void *state, uint64_t seed,
+            uint64_t maxTicks, GameResult_t *result) {
+  Tetris game;
+  int flag = initialGameSeeded(&game, seed);
+  if (flag == OK_) {
+    if (policy->newGame) policy->newGame(state, seed);
+    gameStart(&game);
+    uint64_t ticks = 0;
+    while (game.gameInfo.pause == STARTED && ticks < maxTicks) {
+      userInput(&game, policy->next(state, &game), false);
+      updateCurrentState(&game);
+      ticks++;
+    }
+    result->seed = seed;
+    result->ticks = ticks;
+    result->lines = game.lines;
+    result->pieces = game.pieces;
+    result->score = game.gameInfo.score;
+    result->ended = game.gameInfo.pause == ENDED;
+    freeSpace(&game);
+  }
+  return flag;
+}
+
+/**
+ * @brief Возвращает время указанных часов в секундах.
+ */
+static double clockSeconds(clockid_t clock) {
+  struct timespec now;
+  clock_gettime(clock, &now);
+  return (double)now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Цикл потока: забирает партии по номеру, пока они не закончатся.
+ *
+ * @param arg Указатель на BatchWorker_t.
+ * @return void* Всегда NULL.
+ */
+static void *batchWorker(void *arg) {
+  BatchWorker_t *worker = (BatchWorker_t *)arg;
+  Batch_t *batch = worker->batch;
+  const BatchConfig_t *config = batch->config;
+  double start = clockSeconds(CLOCK_THREAD_CPUTIME_ID);
+  void *state = NULL;
+  bool ready = true;
+  if (config->policy->create) {
+    state = config->policy->create();
+    ready = state != NULL;
+  }
+  long long game;
+  while ((game = __atomic_fetch_add(&batch->nextGame, 1, __ATOMIC_RELAXED)) <
+         config->games) {
+    GameResult_t *result = &batch->results[game];
+    if (!ready || runGame(config->policy, state, config->seed + game,
+                          config->maxTicks, result) != OK_) {
+      memset(result, 0, sizeof(*result));
+      __atomic_fetch_add(&batch->failed, 1, __ATOMIC_RELAXED);
+    }
+  }
+  if (state && config->policy->destroy) config->policy->destroy(state);
+  worker->cpuSeconds = clockSeconds(CLOCK_THREAD_CPUTIME_ID) - start;
+  return NULL;
+}
+
+/**
+ * @brief Играет все партии запуска в config->threads потоках.
+ *
+ * Результат партии зависит только от ее зерна, поэтому results не зависит
+ * от числа потоков. Если часть потоков не запустилась, партии доигрывают
+ * остальные.
+ *
+ * Партия, которую не удалось сыграть (не создалось состояние стратегии
+ * или игра), учитывается в totals->failed, ее результат обнуляется.
+ *
+ * @param config Параметры запуска.
+ * @param results Массив результатов размером config->games.
+ * @param totals Время запуска и количество партий с ошибкой.
+ * @return int OK_, если все партии сыграны, иначе ERROR.
+ */
+int runBatch(const BatchConfig_t *config, GameResult_t *results,
+             BatchTotals_t *totals) {
+  Batch_t batch = {config, results, 0, 0};
+  BatchWorker_t *workers =
+      (BatchWorker_t *)calloc(config->threads, sizeof(BatchWorker_t));
+  int started = 0;
+  double start = clockSeconds(CLOCK_MONOTONIC);
+  for (bool ok = workers != NULL; ok && started < config->threads;) {
+    workers[started].batch = &batch;
+    ok = !pthread_create(&workers[started].thread, NULL, batchWorker,
+                         &workers[started]);
+    if (ok) started++;
+  }
+  totals->cpuSeconds = 0;
+  for (int i = 0; i < started; i++) {
+    pthread_join(workers[i].thread, NULL);
+    totals->cpuSeconds += workers[i].cpuSeconds;
+  }
+  totals->wallSeconds = clockSeconds(CLOCK_MONOTONIC) - start;
+  totals->failed = started > 0 ? batch.failed : config->games;
+  free(workers);
+  return totals->failed == 0 ? OK_ : ERROR;
+}
+
+/**
+ * @brief Сравнивает целые числа для qsort.
+ */
+static int compareInt(const void *a, const void *b) {
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Выводит сводную статистику запуска.
+ *
+ * @param out Поток вывода.
+ * @param config Параметры запуска.
+ * @param results Результаты партий.
+ * @param totals Время запуска и количество партий с ошибкой.
+ */
+void printReport(FILE *out, const BatchConfig_t *config,
+                 const GameResult_t *results, const BatchTotals_t *totals) {
+  double wallSeconds = totals->wallSeconds;
+  double cpuSeconds = totals->cpuSeconds;
+  long long games = config->games;
+  int *scores = (int *)malloc(games * sizeof(int));
+  double scoreSum = 0, lineSum = 0;
+  uint64_t ticks = 0, pieces = 0;
+  uint32_t minLines = UINT32_MAX, maxLines = 0;
+  long long ended = 0;
+  for (long long i = 0; i < games; i++) {
+    if (scores) scores[i] = results[i].score;
+    scoreSum += results[i].score;
+    lineSum += results[i].lines;
+    ticks += results[i].ticks;
+    pieces += results[i].pieces;
+    if (results[i].lines < minLines) minLines = results[i].lines;
+    if (results[i].lines > maxLines) maxLines = results[i].lines;
+    ended += results[i].ended;
+  }
+  fprintf(out, "policy        %s\n", config->policy->name);
+  fprintf(out, "games         %lld (ended %lld, tick limit %lld)\n", games,
+          ended, games - ended);
+  fprintf(out, "failed        %lld\n", totals->failed);
+  fprintf(out, "threads       %d\n", config->threads);
+  fprintf(out, "seeds         %llu..%llu\n", (unsigned long long)config->seed,
+          (unsigned long long)(config->seed + games - 1));
+  if (scores && games > 0) {
+    qsort(scores, games, sizeof(int), compareInt);
+    fprintf(out,
+            "score         mean %.1f  min %d  p10 %d  p50 %d  p90 %d  "
+            "p99 %d  max %d\n",
+            scoreSum / games, scores[0], scores[games / 10],
+            scores[games / 2], scores[games * 9 / 10],
+            scores[games * 99 / 100], scores[games - 1]);
+    fprintf(out, "lines/game    mean %.2f  min %u  max %u\n",
+            lineSum / games, minLines, maxLines);
+    fprintf(out, "pieces/game   mean %.2f\n", (double)pieces / games);
+  }
+  fprintf(out, "wall time     %.3f s\n", wallSeconds);
+  fprintf(out, "pieces/s      %.0f\n",
+          wallSeconds > 0 ? pieces / wallSeconds : 0.0);
+  fprintf(out, "ticks/s/core  %.0f\n",
+          cpuSeconds > 0 ? ticks / cpuSeconds : 0.0);
+  free(scores);
+}
+
+/**
+ * @brief Записывает результаты партий в CSV.
+ *
+ * @param path Путь к файлу.
+ * @param config Параметры запуска.
+ * @param results Результаты партий.
+ * @return int OK_ при успехе, иначе ERROR.
+ */
+int writeResults(const char *path, const BatchConfig_t *config,
+                 const GameResult_t *results) {
+  FILE *file = fopen(path, "w");
+  int flag = file ? OK_ : ERROR;
+  if (file) {
+    fprintf(file, "seed,score,lines,pieces,ticks,ended\n");
+    for (long long i = 0; i < config->games; i++) {
+      fprintf(file, "%llu,%d,%u,%u,%llu,%d\n",
+              (unsigned long long)results[i].seed, results[i].score,
+              results[i].lines, results[i].pieces,
+              (unsigned long long)results[i].ticks, results[i].ended);
+    }
+    fclose(file);
+  }
+  return flag;
+}
@@ -0,0 +1,101 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_BATCH_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_BATCH_H_
+#define BATCH_DEFAULT_GAMES 1000
+#define BATCH_DEFAULT_MAX_TICKS 1000000
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include "tetris_bot.h"
+
+/**
+ * @defgroup TetrisBatch Tetris Batch
+ * Пакетный запуск партий Tetris без интерфейса для сбора статистики.
+ * @ingroup TetrisGame
+ * @{
+ */
+
+/**
+ * @brief Стратегия, управляющая игрой через userInput.
+ *
+ * Состояние стратегии создается один раз на поток и переиспользуется между
+ * партиями этого потока. Решения стратегии должны зависеть только от игры и
+ * зерна партии, иначе результат будет зависеть от распределения по потокам.
+ */
+typedef struct {
+  const char *name;  ///< Имя стратегии для командной строки.
+  /// Создает состояние стратегии (может быть NULL, если состояние не нужно).
+  void *(*create)(void);
+  /// Сообщает о начале новой партии с указанным зерном (может быть NULL).
+  void (*newGame)(void *state, uint64_t seed);
+  /// Возвращает действие для очередного такта.
+  UserAction_t (*next)(void *state, const Tetris *game);
+  /// Освобождает состояние стратегии (может быть NULL).
+  void (*destroy)(void *state);
+} TetrisPolicy_t;
+
+/**
+ * @brief Параметры пакетного запуска.
+ */
+typedef struct {
+  long long games;               ///< Количество партий.
+  int threads;                   ///< Количество потоков.
+  uint64_t seed;                 ///< Зерно первой партии.
+  uint64_t maxTicks;             ///< Предел тактов на партию.
+  const TetrisPolicy_t *policy;  ///< Стратегия.
+  const char *csvPath;  ///< Файл для результатов партий (NULL - не писать).
+} BatchConfig_t;
+
+/**
+ * @brief Результат одной партии.
+ */
+typedef struct {
+  uint64_t seed;    ///< Зерно партии.
+  uint64_t ticks;   ///< Количество тактов.
+  uint32_t lines;   ///< Удаленные строки.
+  uint32_t pieces;  ///< Закрепленные фигуры.
+  int score;        ///< Итоговый счет.
+  bool ended;       ///< Партия проиграна, а не остановлена по пределу тактов.
+} GameResult_t;
+
+/**
+ * @brief Итоги пакетного запуска.
+ */
+typedef struct {
+  double wallSeconds;  ///< Общее время запуска.
+  double cpuSeconds;   ///< Суммарное процессорное время потоков.
+  long long failed;    ///< Количество партий с ошибкой запуска.
+} BatchTotals_t;
+
+/**
+ * @brief Общее состояние пакетного запуска.
+ */
+typedef struct {
+  const BatchConfig_t *config;  ///< Параметры запуска.
+  GameResult_t *results;        ///< Результаты партий по номеру.
+  long long nextGame;           ///< Номер следующей свободной партии.
+  long long failed;             ///< Количество партий с ошибкой запуска.
+} Batch_t;
+
+/**
+ * @brief Поток пакетного запуска и его счетчики.
+ */
+typedef struct {
+  Batch_t *batch;     ///< Общее состояние.
+  pthread_t thread;   ///< Поток.
+  double cpuSeconds;  ///< Процессорное время потока.
+} BatchWorker_t;
+
+const TetrisPolicy_t *findPolicy(const char *name);
+int runGame(const TetrisPolicy_t *policy, void *state, uint64_t seed,
+            uint64_t maxTicks, GameResult_t *result);
+int runBatch(const BatchConfig_t *config, GameResult_t *results,
+             BatchTotals_t *totals);
+void printReport(FILE *out, const BatchConfig_t *config,
+                 const GameResult_t *results, const BatchTotals_t *totals);
+int writeResults(const char *path, const BatchConfig_t *config,
+                 const GameResult_t *results);
+
+/** @} */  // TetrisBatch
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_BATCH_H_
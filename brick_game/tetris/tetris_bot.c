@@ -0,0 +1,602 @@
+#include "tetris_bot.h"
+
+/**
+ * @brief Возвращает веса эвристики по умолчанию.
+ *
+ * @return BotWeights_t Веса, подобранные для поля 10x20.
+ */
+BotWeights_t botDefaultWeights(void) {
+  BotWeights_t weights = {-0.510066, -0.35663, -0.184483, 0.760666};
+  return weights;
+}
+
+/**
+ * @brief Переносит маску строки фигуры в координаты строки поля.
+ *
+ * @param shapeRow Маска строки фигуры.
+ * @param x Позиция фигуры по оси X.
+ * @return uint16_t Маска строки поля.
+ */
+static uint16_t botShiftRow(uint16_t shapeRow, int x) {
+  return (uint16_t)(x >= 0 ? shapeRow << x : shapeRow >> -x);
+}
+
+/**
+ * @brief Проверяет позицию по правилам сдвига (см. isValidPosition).
+ *
+ * @param rows Битовое поле; NULL, если строки под фигурой заведомо пусты.
+ * @param index Индекс фигуры.
+ * @param x Позиция по оси X.
+ * @param y Позиция по оси Y.
+ * @return true Если фигура целиком на поле и не пересекает клетки.
+ */
+static bool botFits(const uint16_t *rows, int index, int x, int y) {
+  const Tetromino_t *t = &TETROMINOS[index];
+  bool valid = x + t->minX >= 0 && x + t->maxX < WIDTH && y + t->minY >= 0 &&
+               y + t->maxY < HEIGHT;
+  for (int i = t->minY; i <= t->maxY && valid && rows; i++) {
+    valid = !(rows[y + i] & botShiftRow(t->rows[i], x));
+  }
+  return valid;
+}
+
+/**
+ * @brief Проверяет позицию по правилам поворота (см. canRotate).
+ *
+ * @param rows Битовое поле; NULL, если строки под фигурой заведомо пусты.
+ * @param index Индекс фигуры после поворота.
+ * @param x Позиция по оси X.
+ * @param y Позиция по оси Y.
+ * @return true Если фигура помещается, клетки выше поля допускаются.
+ */
+static bool botFitsRotated(const uint16_t *rows, int index, int x, int y) {
+  const Tetromino_t *t = &TETROMINOS[index];
+  bool valid = x + t->minX >= 0 && x + t->maxX < WIDTH && y + t->maxY < HEIGHT;
+  for (int i = t->minY; i <= t->maxY && valid && rows; i++) {
+    valid = y + i < 0 || !(rows[y + i] & botShiftRow(t->rows[i], x));
+  }
+  return valid;
+}
+
+/**
+ * @brief Проверяет, опирается ли фигура на дно или клетки поля.
+ *
+ * @param rows Битовое поле.
+ * @param index Индекс фигуры.
+ * @param x Позиция по оси X.
+ * @param y Позиция по оси Y.
+ * @return true Если фигура не может опуститься ниже.
+ */
+static bool botResting(const uint16_t *rows, int index, int x, int y) {
+  const Tetromino_t *t = &TETROMINOS[index];
+  bool resting = y + t->maxY >= HEIGHT - 1;
+  for (int i = t->maxY; i >= t->minY && !resting; i--) {
+    int below = y + i + 1;
+    resting = below >= 0 && (rows[below] & botShiftRow(t->rows[i], x));
+  }
+  return resting;
+}
+
+/**
+ * @brief Вычисляет поверхность поля, количество дыр, сумму высот и
+ * перепадов.
+ *
+ * @param rows Битовое поле.
+ * @param surface Поверхность; для пустого столбца top равен HEIGHT.
+ */
+static void botSurface(const uint16_t *rows, BotSurface_t *surface) {
+  uint16_t seen = 0;
+  int i = 0;
+  while (i < HEIGHT && !rows[i]) i++;
+  surface->stackTop = i;
+  surface->holes = 0;
+  for (int j = 0; j < WIDTH; j++) surface->top[j] = HEIGHT;
+  for (; i < HEIGHT; i++) {
+    surface->holes += __builtin_popcount(seen & (uint16_t)~rows[i]);
+    uint16_t fresh = rows[i] & (uint16_t)~seen;
+    while (fresh) {
+      surface->top[__builtin_ctz(fresh)] = (int8_t)i;
+      fresh &= (uint16_t)(fresh - 1);
+    }
+    seen |= rows[i];
+  }
+  surface->aggregate = HEIGHT - surface->top[0];
+  surface->bumpiness = 0;
+  for (int j = 1; j < WIDTH; j++) {
+    surface->aggregate += HEIGHT - surface->top[j];
+    surface->bumpiness += abs(surface->top[j] - surface->top[j - 1]);
+  }
+}
+
+/**
+ * @brief Находит высоту падения фигуры, целиком находящейся над
+ * поверхностью поля.
+ *
+ * @param surface Поверхность поля.
+ * @param index Индекс фигуры.
+ * @param x Позиция фигуры по оси X.
+ * @return int Позиция закрепления по оси Y.
+ */
+static int botLanding(const BotSurface_t *surface, int index, int x) {
+  const Tetromino_t *t = &TETROMINOS[index];
+  int y = HEIGHT;
+  for (int k = 0; k < 4; k++) {
+    int landing = surface->top[x + t->cells[k][1]] - 1 - t->cells[k][0];
+    if (landing < y) y = landing;
+  }
+  return y;
+}
+
+/**
+ * @brief Выбирает действие, ведущее фигуру к цели.
+ *
+ * Сначала фигура поворачивается, затем сдвигается, затем опускается.
+ * Поиск моделирует ровно это правило, поэтому найденные размещения
+ * достижимы.
+ *
+ * @return UserAction_t Следующее действие.
+ */
+static UserAction_t botSteer(int index, int x, int targetIndex, int targetX) {
+  UserAction_t action = Down;
+  if (index != targetIndex) {
+    action = Action;
+  } else if (x < targetX) {
+    action = Right;
+  } else if (x > targetX) {
+    action = Left;
+  }
+  return action;
+}
+
+/**
+ * @brief Проверяет, проходит ли путь фигуры к цели целиком над поверхностью.
+ *
+ * Путь botSteer - повороты на месте, затем сдвиги, затем падение; за
+ * каждое действие фигура опускается на строку. Если рамка 4x4 остается
+ * выше поверхности до последнего действия, поле на пути ничего не меняет:
+ * достаточно проверить границы поворотов, а сдвиги к цели внутри поля
+ * всегда возможны.
+ *
+ * @param surface Поверхность поля.
+ * @param index Индекс фигуры.
+ * @param x Позиция фигуры по оси X.
+ * @param y Позиция фигуры по оси Y.
+ * @param target Цель того же типа фигуры.
+ * @return true Если путь не касается поля и фигура дойдет до цели.
+ */
+static bool botClearPath(const BotSurface_t *surface, int index, int x, int y,
+                         const Placement_t *target) {
+  int turns =
+      (PIECE_ROTATION(target->indexTetramino) - PIECE_ROTATION(index) + 4) % 4;
+  bool clear = PIECE_TYPE(index) == PIECE_TYPE(target->indexTetramino) &&
+               y + turns + abs(target->x - x) + 4 < surface->stackTop;
+  for (int k = 0; k < turns && clear; k++) {
+    index = (index + TETROMINO_TYPES) % TETROMINO_COUNT;
+    clear = botFitsRotated(NULL, index, x, y + k);
+  }
+  return clear;
+}
+
+/**
+ * @brief Моделирует ведение фигуры к цели до ее закрепления.
+ *
+ * На каждом шаге выполняется одно действие botSteer и один шаг гравитации,
+ * как при вызове userInput и updateCurrentState за такт. Пока рамка 4x4
+ * фигуры и строка под ней выше поверхности, строки поля не читаются; если
+ * так проходит весь путь (botClearPath), высота закрепления берется сразу
+ * из поверхности.
+ *
+ * @param rows Битовое поле.
+ * @param surface Поверхность того же поля.
+ * @param index Индекс фигуры.
+ * @param x Позиция фигуры по оси X.
+ * @param y Позиция фигуры по оси Y.
+ * @param target Цель; при успехе в target->y записывается высота закрепления.
+ * @return true Если фигура закрепилась в цели.
+ */
+static bool botSimulate(const uint16_t *rows, const BotSurface_t *surface,
+                        int index, int x, int y, Placement_t *target) {
+  bool reached = botClearPath(surface, index, x, y, target);
+  bool locked = reached;
+  if (reached) y = botLanding(surface, target->indexTetramino, target->x);
+  for (int step = 0; step < BOT_MAX_STEPS && !locked; step++) {
+    const uint16_t *near = y + 4 < surface->stackTop ? NULL : rows;
+    switch (botSteer(index, x, target->indexTetramino, target->x)) {
+      case Action: {
+        int rotated = (index + TETROMINO_TYPES) % TETROMINO_COUNT;
+        if (botFitsRotated(near, rotated, x, y)) index = rotated;
+        break;
+      }
+      case Left:
+        if (botFits(near, index, x - 1, y)) x--;
+        break;
+      case Right:
+        if (botFits(near, index, x + 1, y)) x++;
+        break;
+      default:
+        if (near) {
+          while (!botResting(rows, index, x, y)) y++;
+        } else {
+          y = botLanding(surface, index, x);
+        }
+        break;
+    }
+    locked = (y + 4 >= surface->stackTop) && botResting(rows, index, x, y);
+    if (locked) {
+      reached = index == target->indexTetramino && x == target->x;
+    } else {
+      y++;
+    }
+  }
+  if (reached) target->y = y;
+  return reached;
+}
+
+/**
+ * @brief Закрепляет фигуру на копии поля и удаляет заполненные строки.
+ *
+ * @param rows Битовое поле, изменяется на месте.
+ * @param placement Размещение; в placement->lines записываются линии.
+ * @return true Если размещение не приводит к проигрышу.
+ */
+static bool botPlace(uint16_t *rows, Placement_t *placement) {
+  const Tetromino_t *t = &TETROMINOS[placement->indexTetramino];
+  int y = placement->y;
+  bool alive = y + t->minY >= 0 && rows[0] == 0;
+  bool full = false;
+  for (int i = t->minY; i <= t->maxY && alive; i++) {
+    rows[y + i] |= botShiftRow(t->rows[i], placement->x);
+    full = full || rows[y + i] == FULL_ROW;
+  }
+  int write = y + t->maxY;
+  for (int read = write; read >= 0 && alive && full; read--) {
+    if (rows[read] != FULL_ROW) rows[write--] = rows[read];
+  }
+  placement->lines = full && alive ? write + 1 : 0;
+  for (; write >= 0 && alive && full; write--) rows[write] = 0;
+  return alive && rows[0] == 0;
+}
+
+/**
+ * @brief Вычисляет оценку по признакам поля.
+ *
+ * @param weights Веса эвристики.
+ * @param surface Поверхность поля (сумма высот, перепады и дыры).
+ * @param lines Количество удаленных линий.
+ * @return double Оценка поля, чем больше, тем лучше.
+ */
+static double botScore(const BotWeights_t *weights,
+                       const BotSurface_t *surface, int lines) {
+  return weights->height * surface->aggregate +
+         weights->holes * surface->holes +
+         weights->bumpiness * surface->bumpiness + weights->lines * lines;
+}
+
+/**
+ * @brief Оценивает поле эвристикой бота.
+ *
+ * @param weights Веса эвристики.
+ * @param rows Битовое поле.
+ * @param lines Количество удаленных линий.
+ * @return double Оценка поля, чем больше, тем лучше.
+ */
+static double botEvaluate(const BotWeights_t *weights, const uint16_t *rows,
+                          int lines) {
+  BotSurface_t surface;
+  botSurface(rows, &surface);
+  return botScore(weights, &surface, lines);
+}
+
+/**
+ * @brief Оценивает размещение без копирования поля.
+ *
+ * Применимо, когда фигура лежит целиком над поверхностью своих столбцов и
+ * не заполняет строк: тогда меняются только высоты этих столбцов, а новые
+ * дыры - клетки между фигурой и прежней поверхностью. Сумма высот и
+ * перепады пересчитываются только для этих столбцов и их соседей.
+ *
+ * @param weights Веса эвристики.
+ * @param rows Битовое поле до размещения.
+ * @param surface Поверхность того же поля.
+ * @param placement Размещение.
+ * @param lines Линии, удаленные предыдущими размещениями.
+ * @param score Оценка размещения.
+ * @return true Если оценка вычислена, иначе нужна botEvaluate.
+ */
+static bool botEvaluateStacked(const BotWeights_t *weights,
+                               const uint16_t *rows,
+                               const BotSurface_t *surface,
+                               const Placement_t *placement, int lines,
+                               double *score) {
+  const Tetromino_t *t = &TETROMINOS[placement->indexTetramino];
+  int y = placement->y;
+  bool stacked = y + t->minY >= 0;
+  for (int i = t->minY; i <= t->maxY && stacked; i++) {
+    stacked = (rows[y + i] | botShiftRow(t->rows[i], placement->x)) != FULL_ROW;
+  }
+  BotSurface_t after;
+  int8_t lowest[4] = {-1, -1, -1, -1};
+  memcpy(after.top, surface->top, sizeof(after.top));
+  for (int k = 0; k < 4 && stacked; k++) {
+    int cy = y + t->cells[k][0];
+    int cx = placement->x + t->cells[k][1];
+    stacked = cy < surface->top[cx];
+    if (cy < after.top[cx]) after.top[cx] = (int8_t)cy;
+    if (cy > lowest[t->cells[k][1]]) lowest[t->cells[k][1]] = (int8_t)cy;
+  }
+  if (stacked) {
+    int first = placement->x + t->minX;
+    int last = placement->x + t->maxX;
+    after.holes = surface->holes;
+    after.aggregate = surface->aggregate;
+    after.bumpiness = surface->bumpiness;
+    for (int j = 0; j < 4; j++) {
+      if (lowest[j] >= 0) {
+        after.holes += surface->top[placement->x + j] - 1 - lowest[j];
+      }
+    }
+    for (int j = first; j <= last; j++) {
+      after.aggregate += surface->top[j] - after.top[j];
+    }
+    for (int j = first > 1 ? first : 1; j <= last + 1 && j < WIDTH; j++) {
+      after.bumpiness += abs(after.top[j] - after.top[j - 1]) -
+                         abs(surface->top[j] - surface->top[j - 1]);
+    }
+    *score = y + t->minY > 0 ? botScore(weights, &after, lines)
+                             : BOT_LOSS_SCORE;
+  }
+  return stacked;
+}
+
+/**
+ * @brief Проверяет, повторяет ли поворот форму одного из предыдущих.
+ *
+ * @param index Индекс фигуры.
+ * @return true Если поворот с меньшим номером имеет ту же форму.
+ */
+static bool botDuplicateRotation(int index) {
+  const Tetromino_t *t = &TETROMINOS[index];
+  bool duplicate = false;
+  for (int r = 0; r < PIECE_ROTATION(index) && !duplicate; r++) {
+    const Tetromino_t *other =
+        &TETROMINOS[PIECE_INDEX(PIECE_TYPE(index), r)];
+    duplicate = !memcmp(t->rows, other->rows, sizeof(t->rows));
+  }
+  return duplicate;
+}
+
+/**
+ * @brief Заполняет список целей для фигуры: все повороты и столбцы.
+ *
+ * @param type Тип фигуры.
+ * @param targets Массив целей размером не меньше BOT_MAX_TARGETS.
+ * @return int Количество целей.
+ */
+static int botTargets(int type, Placement_t *targets) {
+  int count = 0;
+  for (int r = 0; r < 4; r++) {
+    int index = PIECE_INDEX(type, r);
+    const Tetromino_t *t = &TETROMINOS[index];
+    if (botDuplicateRotation(index)) continue;
+    for (int x = -t->minX; x + t->maxX < WIDTH; x++) {
+      Placement_t target = {index, x, 0, 0, 0};
+      targets[count++] = target;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Оценивает один вариант размещения текущей фигуры.
+ *
+ * При bot->indexNext >= 0 оценка равна лучшей оценке поля после
+ * размещения следующей фигуры.
+ *
+ * @param bot Указатель на бота.
+ * @param job Вариант размещения.
+ * @return long long Количество оцененных состояний поля.
+ */
+static long long botRunJob(const TetrisBot_t *bot, BotJob_t *job) {
+  uint16_t rows[HEIGHT];
+  long long evaluated = 0;
+  memcpy(rows, bot->rows, sizeof(rows));
+  job->reachable = botSimulate(rows, &bot->surface, bot->index, bot->x,
+                               bot->y, &job->placement);
+  if (!job->reachable) {
+    job->placement.score = BOT_LOSS_SCORE;
+  } else if (!botPlace(rows, &job->placement)) {
+    job->placement.score = BOT_LOSS_SCORE;
+    evaluated++;
+  } else if (bot->indexNext < 0) {
+    job->placement.score =
+        botEvaluate(&bot->weights, rows, job->placement.lines);
+    evaluated++;
+  } else {
+    Placement_t targets[BOT_MAX_TARGETS];
+    int count = bot->nextTargetCount;
+    memcpy(targets, bot->nextTargets, count * sizeof(Placement_t));
+    double best = BOT_LOSS_SCORE;
+    BotSurface_t surface;
+    botSurface(rows, &surface);
+    for (int k = 0; k < count; k++) {
+      double score = BOT_LOSS_SCORE;
+      if (!botSimulate(rows, &surface, bot->indexNext, WIDTH / 2 - 2, -2,
+                       &targets[k])) {
+        continue;
+      } else if (!botEvaluateStacked(&bot->weights, rows, &surface,
+                                     &targets[k], job->placement.lines,
+                                     &score)) {
+        uint16_t next[HEIGHT];
+        memcpy(next, rows, sizeof(next));
+        if (botPlace(next, &targets[k])) {
+          score = botEvaluate(&bot->weights, next,
+                              job->placement.lines + targets[k].lines);
+        }
+      }
+      if (score > best) best = score;
+      evaluated++;
+    }
+    job->placement.score = best;
+  }
+  return evaluated;
+}
+
+/**
+ * @brief Разбирает варианты текущего поиска, пока они не закончатся.
+ *
+ * @param bot Указатель на бота.
+ */
+static void botRunJobs(TetrisBot_t *bot) {
+  long long evaluated = 0;
+  int job;
+  while ((job = __atomic_fetch_add(&bot->nextJob, 1, __ATOMIC_RELAXED)) <
+         bot->jobCount) {
+    evaluated += botRunJob(bot, &bot->jobs[job]);
+  }
+  __atomic_fetch_add(&bot->evaluated, evaluated, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Цикл рабочего потока: ждет поиск, участвует в нем, сообщает о
+ * завершении.
+ *
+ * @param arg Указатель на бота.
+ * @return void* Всегда NULL.
+ */
+static void *botWorker(void *arg) {
+  TetrisBot_t *bot = (TetrisBot_t *)arg;
+  unsigned seen = 0;
+  pthread_mutex_lock(&bot->mutex);
+  while (!bot->stop) {
+    if (bot->generation == seen) {
+      pthread_cond_wait(&bot->start, &bot->mutex);
+    } else {
+      seen = bot->generation;
+      pthread_mutex_unlock(&bot->mutex);
+      botRunJobs(bot);
+      pthread_mutex_lock(&bot->mutex);
+      if (--bot->working == 0) pthread_cond_signal(&bot->done);
+    }
+  }
+  pthread_mutex_unlock(&bot->mutex);
+  return NULL;
+}
+
+/**
+ * @brief Создает бота и запускает пул потоков.
+ *
+ * @param bot Указатель на бота.
+ * @param threads Общее число потоков поиска, включая вызывающий.
+ * @param weights Веса эвристики.
+ * @return int OK_ при успехе, иначе ERROR.
+ */
+int botCreate(TetrisBot_t *bot, int threads, BotWeights_t weights) {
+  memset(bot, 0, sizeof(*bot));
+  bot->weights = weights;
+  pthread_mutex_init(&bot->mutex, NULL);
+  pthread_cond_init(&bot->start, NULL);
+  pthread_cond_init(&bot->done, NULL);
+  int flag = OK_;
+  if (threads > 1) {
+    bot->workers = (pthread_t *)calloc(threads - 1, sizeof(pthread_t));
+    flag = bot->workers ? OK_ : ERROR;
+  }
+  for (int i = 0; i < threads - 1 && flag == OK_; i++) {
+    if (pthread_create(&bot->workers[i], NULL, botWorker, bot) == 0) {
+      bot->workerCount++;
+    } else {
+      flag = ERROR;
+    }
+  }
+  if (flag != OK_) botDestroy(bot);
+  return flag;
+}
+
+/**
+ * @brief Останавливает потоки и освобождает ресурсы бота.
+ *
+ * @param bot Указатель на бота.
+ */
+void botDestroy(TetrisBot_t *bot) {
+  pthread_mutex_lock(&bot->mutex);
+  bot->stop = true;
+  pthread_cond_broadcast(&bot->start);
+  pthread_mutex_unlock(&bot->mutex);
+  for (int i = 0; i < bot->workerCount; i++) {
+    pthread_join(bot->workers[i], NULL);
+  }
+  free(bot->workers);
+  bot->workers = NULL;
+  bot->workerCount = 0;
+  pthread_cond_destroy(&bot->done);
+  pthread_cond_destroy(&bot->start);
+  pthread_mutex_destroy(&bot->mutex);
+}
+
+/**
+ * @brief Ищет лучшее достижимое размещение текущей фигуры.
+ *
+ * Варианты (поворот x столбец) распределяются между потоками пула и
+ * вызывающим потоком. Каждый вариант моделируется по правилам botNextAction.
+ *
+ * @param bot Указатель на бота.
+ * @param game Указатель на структуру Tetris.
+ * @param useNext Учитывать следующую фигуру.
+ * @param best Лучшее размещение.
+ * @return true Если найдено хотя бы одно достижимое размещение.
+ */
+bool botFindPlacement(TetrisBot_t *bot, const Tetris *game, bool useNext,
+                      Placement_t *best) {
+  memcpy(bot->rows, game->board.rows, sizeof(bot->rows));
+  botSurface(bot->rows, &bot->surface);
+  bot->index = game->figure.indexTetramino;
+  bot->x = game->figure.x;
+  bot->y = game->figure.y;
+  bot->indexNext = useNext ? game->figure.indexNext : -1;
+
+  Placement_t targets[BOT_MAX_TARGETS];
+  bot->jobCount = botTargets(PIECE_TYPE(bot->index), targets);
+  for (int k = 0; k < bot->jobCount; k++) {
+    bot->jobs[k].placement = targets[k];
+    bot->jobs[k].reachable = false;
+  }
+  if (useNext) {
+    bot->nextTargetCount =
+        botTargets(PIECE_TYPE(bot->indexNext), bot->nextTargets);
+  }
+  bot->nextJob = 0;
+
+  pthread_mutex_lock(&bot->mutex);
+  bot->working = bot->workerCount;
+  bot->generation++;
+  pthread_cond_broadcast(&bot->start);
+  pthread_mutex_unlock(&bot->mutex);
+  botRunJobs(bot);
+  pthread_mutex_lock(&bot->mutex);
+  while (bot->working > 0) pthread_cond_wait(&bot->done, &bot->mutex);
+  pthread_mutex_unlock(&bot->mutex);
+
+  bool found = false;
+  for (int k = 0; k < bot->jobCount; k++) {
+    const BotJob_t *job = &bot->jobs[k];
+    if (job->reachable && (!found || job->placement.score > best->score)) {
+      *best = job->placement;
+      found = true;
+    }
+  }
+  return found;
+}
+
+/**
+ * @brief Возвращает следующее действие для ведения фигуры к размещению.
+ *
+ * Рассчитано на один вызов userInput на каждый шаг updateCurrentState.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @param target Размещение, найденное botFindPlacement.
+ * @return UserAction_t Действие для userInput.
+ */
+UserAction_t botNextAction(const Tetris *game, const Placement_t *target) {
+  return botSteer(game->figure.indexTetramino, game->figure.x,
+                  target->indexTetramino, target->x);
+}
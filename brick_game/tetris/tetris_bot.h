@@ -0,0 +1,95 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_BOT_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_BOT_H_
+#define BOT_MAX_TARGETS (4 * WIDTH)
+#define BOT_MAX_STEPS (2 * HEIGHT + 4 * WIDTH)
+#define BOT_LOSS_SCORE (-1e9)
+
+#include <pthread.h>
+
+#include "tetris_backend.h"
+
+/**
+ * @defgroup TetrisBot Tetris Bot
+ * Поиск размещения фигур для автоматической игры.
+ * @ingroup TetrisGame
+ * @{
+ */
+
+/**
+ * @brief Веса эвристики оценки поля.
+ */
+typedef struct {
+  double height;     ///< Вес суммарной высоты столбцов.
+  double holes;      ///< Вес количества дыр.
+  double bumpiness;  ///< Вес суммы перепадов высот соседних столбцов.
+  double lines;      ///< Вес количества удаленных линий.
+} BotWeights_t;
+
+/**
+ * @brief Конечное размещение фигуры, найденное ботом.
+ */
+typedef struct {
+  int indexTetramino;  ///< Индекс фигуры (тип и поворот) при закреплении.
+  int x;               ///< Позиция закрепления по оси X.
+  int y;               ///< Позиция закрепления по оси Y.
+  int lines;           ///< Количество линий, удаляемых размещением.
+  double score;        ///< Оценка размещения.
+} Placement_t;
+
+/**
+ * @brief Признаки поля: верхние занятые строки столбцов и дыры.
+ */
+typedef struct {
+  int8_t top[WIDTH];  ///< Верхняя занятая строка столбца (HEIGHT - пусто).
+  int stackTop;       ///< Верхняя непустая строка поля.
+  int holes;          ///< Пустые клетки под занятыми.
+  int aggregate;      ///< Сумма высот столбцов.
+  int bumpiness;      ///< Сумма перепадов высот соседних столбцов.
+} BotSurface_t;
+
+/**
+ * @brief Вариант размещения текущей фигуры и его результат.
+ */
+typedef struct {
+  Placement_t placement;  ///< Целевое размещение.
+  bool reachable;         ///< Фигуру можно довести до цели.
+} BotJob_t;
+
+/**
+ * @brief Бот с пулом потоков для параллельной оценки размещений.
+ */
+typedef struct {
+  BotWeights_t weights;  ///< Веса эвристики.
+  int workerCount;       ///< Количество рабочих потоков.
+  pthread_t *workers;    ///< Рабочие потоки.
+  pthread_mutex_t mutex;  ///< Защищает поля синхронизации ниже.
+  pthread_cond_t start;   ///< Сигнал о новом поиске.
+  pthread_cond_t done;    ///< Сигнал о завершении поиска потоками.
+  unsigned generation;    ///< Номер текущего поиска.
+  int working;            ///< Потоки, еще занятые текущим поиском.
+  bool stop;              ///< Потоки должны завершиться.
+
+  uint16_t rows[HEIGHT];  ///< Снимок битового поля для текущего поиска.
+  BotSurface_t surface;   ///< Поверхность снимка поля.
+  int index;              ///< Текущая фигура.
+  int x;                  ///< Позиция текущей фигуры по оси X.
+  int y;                  ///< Позиция текущей фигуры по оси Y.
+  int indexNext;          ///< Следующая фигура (-1 - не учитывать).
+  BotJob_t jobs[BOT_MAX_TARGETS];  ///< Варианты размещения текущей фигуры.
+  int jobCount;                    ///< Количество вариантов.
+  Placement_t nextTargets[BOT_MAX_TARGETS];  ///< Цели следующей фигуры.
+  int nextTargetCount;                       ///< Количество целей.
+  int nextJob;            ///< Индекс следующего свободного варианта.
+  long long evaluated;    ///< Всего оцененных состояний поля.
+} TetrisBot_t;
+
+BotWeights_t botDefaultWeights(void);
+int botCreate(TetrisBot_t *bot, int threads, BotWeights_t weights);
+void botDestroy(TetrisBot_t *bot);
+bool botFindPlacement(TetrisBot_t *bot, const Tetris *game, bool useNext,
+                      Placement_t *best);
+UserAction_t botNextAction(const Tetris *game, const Placement_t *target);
+
+/** @} */  // TetrisBot
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_BOT_H_
@@ -0,0 +1,63 @@
+#include "tetris_score.h"
+
+/**
+ * @brief Считывает рекордный счет из файла.
+ *
+ * @param game Указатель на структуру Tetris.
+ */
+void readHighScore(Tetris *game) {
+  game->gameInfo.high_score = scoreStoreRead(scoreStoreOpen(SCORE_FILE));
+}
+
+/**
+ * @brief Записывает рекордный счет в файл и дожидается записи.
+ *
+ * @param game Указатель на структуру Tetris.
+ */
+void writeHighScore(Tetris *game) {
+  if (game->gameInfo.score >= game->gameInfo.high_score) {
+    game->gameInfo.high_score = game->gameInfo.score;
+    ScoreStore_t *store = scoreStoreOpen(SCORE_FILE);
+    scoreStoreSet(store, game->gameInfo.high_score);
+    scoreStoreFlush(store);
+  }
+}
+
+/**
+ * @brief Передает рекорд фоновому потоку записи, не дожидаясь записи.
+ *
+ * Вызывается ядром при каждом новом рекорде во время игры.
+ *
+ * @param game Указатель на структуру Tetris.
+ */
+static void queueHighScore(Tetris *game) {
+  if (game->gameInfo.score >= game->gameInfo.high_score) {
+    game->gameInfo.high_score = game->gameInfo.score;
+    scoreStoreSet(scoreStoreOpen(SCORE_FILE), game->gameInfo.high_score);
+  }
+}
+
+/**
+ * @brief Дожидается записи рекорда в файл в конце игры.
+ *
+ * @param game Указатель на структуру Tetris.
+ */
+static void flushHighScore(Tetris *game) {
+  (void)game;
+  scoreStoreFlush(scoreStoreOpen(SCORE_FILE));
+}
+
+/**
+ * @brief Подключает файл рекордов к игре.
+ *
+ * Загружает рекорд и назначает обработчики сохранения: во время игры рекорд
+ * записывается фоновым потоком, при завершении игры запись дожидается.
+ * Вызывается фронтендами после initialGame.
+ *
+ * @param game Указатель на структуру Tetris.
+ */
+void attachHighScoreFile(Tetris *game) {
+  readHighScore(game);
+  game->saveHighScore = queueHighScore;
+  game->flushHighScore = flushHighScore;
+}
@@ -0,0 +1,24 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_SCORE_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_SCORE_H_
+#define SCORE_FILE "TetrisHighScore.txt"
+
+#include <stdio.h>
+
+#include "../common/score_store.h"
+#include "tetris_backend.h"
+
+/**
+ * @defgroup TetrisScore Tetris High Score
+ * Хранение рекорда Tetris в файле через CommonScoreStore. Ядро игры
+ * (tetris_backend.c) с файлами не работает и получает рекорд через
+ * attachHighScoreFile.
+ * @ingroup TetrisGame
+ * @{
+ */
+void readHighScore(Tetris *game);
+void writeHighScore(Tetris *game);
+void attachHighScoreFile(Tetris *game);
+
+/** @} */  // TetrisScore
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_SCORE_H_
@@ -0,0 +1,191 @@
+#include "tetris_sim.h"
+
+/**
+ * @brief Шаг игры для потока: tetrisSimRun с аргументом void *.
+ *
+ * @param context Указатель на TetrisSim_t.
+ */
+static int64_t tetrisSimStep(void *context) {
+  return tetrisSimRun((TetrisSim_t *)context);
+}
+
+/**
+ * @brief Подготавливает игру к работе в потоке, не запуская его.
+ *
+ * Игра должна быть инициализирована; кадры и планировщик тактов
+ * начинаются заново. Задержки не измеряются, пока фронтенд не задаст
+ * sim->latency.
+ *
+ * @param sim Указатель на структуру потока игры.
+ * @param game Игра.
+ * @param notify Вызывается из потока игры, когда появился кадр, который
+ * читатель еще не видел (NULL - не уведомлять).
+ * @param context Аргумент notify.
+ */
+void tetrisSimInit(TetrisSim_t *sim, Tetris *game,
+                   void (*notify)(void *context), void *context) {
+  memset(sim->slots, 0, sizeof(sim->slots));
+  sim->game = game;
+  sim->sequence = 0;
+  sim->notify = notify;
+  sim->context = context;
+  sim->latency = NULL;
+  tickInit(&sim->ticks, gravityPeriodNs(game), tickNow());
+  simThreadInit(&sim->thread, tetrisSimStep, sim);
+  simFramesInit(&sim->frames);
+}
+
+/**
+ * @brief Запускает поток игры.
+ *
+ * @param sim Указатель на структуру потока игры.
+ * @return true Поток запущен, false - tetrisSimRun вызывает фронтенд.
+ */
+bool tetrisSimStart(TetrisSim_t *sim) {
+  tickSkip(&sim->ticks, tickNow());
+  return simThreadStart(&sim->thread);
+}
+
+/**
+ * @brief Останавливает поток игры; после этого игру можно менять напрямую.
+ *
+ * @param sim Указатель на структуру потока игры.
+ */
+void tetrisSimStop(TetrisSim_t *sim) { simThreadStop(&sim->thread); }
+
+/**
+ * @brief Передает ввод игре.
+ *
+ * Не ждет потока игры: событие ставится в очередь, поток будится. Без
+ * потока событие обработает следующий вызов tetrisSimRun.
+ *
+ * @param sim Указатель на структуру потока игры.
+ * @param action Действие пользователя.
+ * @param hold Удержание клавиши.
+ * @return true Событие принято, false - очередь заполнена.
+ */
+bool tetrisSimInput(TetrisSim_t *sim, UserAction_t action, bool hold) {
+  return simThreadPost(&sim->thread, action, hold);
+}
+
+/**
+ * @brief Копирует состояние игры в свободный кадр и публикует его.
+ *
+ * Текущая фигура рисуется в клетки кадра, пока игра не окончена, как это
+ * делали фронтенды.
+ *
+ * @param sim Указатель на структуру потока игры.
+ */
+static void tetrisSimPublish(TetrisSim_t *sim) {
+  ALLOC_PHASE(ALLOC_RENDER);
+  Tetris *game = sim->game;
+  TetrisFrame_t *frame = &sim->slots[sim->frames.back];
+  const TetrisFrame_t *previous = &sim->slots[sim->frames.published];
+  getGameInfo(game);
+  FrameDiff_t diff = takeFrameDiff(game);
+  for (int i = 0; i < HEIGHT; i++) {
+    memcpy(frame->cells[i], game->gameInfo.field[i], sizeof(frame->cells[i]));
+  }
+  if (game->gameInfo.pause != ENDED) {
+    const Tetromino_t *t = &TETROMINOS[game->figure.indexTetramino];
+    for (int k = 0; k < 4; k++) {
+      int y = game->figure.y + t->cells[k][0];
+      int x = game->figure.x + t->cells[k][1];
+      if (y >= 0 && y < HEIGHT && x >= 0 && x < WIDTH) {
+        frame->cells[y][x] = PIECE_TYPE(game->figure.indexTetramino) + 1;
+      }
+    }
+  }
+  int nextColor = PIECE_TYPE(game->figure.indexNext) + 1;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      frame->next[i][j] = game->gameInfo.next[i][j] ? nextColor : 0;
+    }
+  }
+  frame->hud = game->shownHud;
+  frame->sequence = ++sim->sequence;
+  for (int i = 0; i < HEIGHT; i++) {
+    frame->rowSequence[i] =
+        diff.rows & (1u << i) ? sim->sequence : previous->rowSequence[i];
+  }
+  for (int k = 0; k < FRAME_HUD_ITEMS; k++) {
+    frame->hudSequence[k] =
+        diff.hud & (1 << k) ? sim->sequence : previous->hudSequence[k];
+  }
+  if (simFramesPublish(&sim->frames) && sim->notify) {
+    sim->notify(sim->context);
+  }
+}
+
+/**
+ * @brief Шаг игры: ввод из очереди, накопленные такты гравитации, новый
+ * кадр.
+ *
+ * Вызывается потоком игры или, если поток не запущен, фронтендом. Время,
+ * пока игра не шла, тактами не становится. С sim->latency записываются
+ * длительность каждого такта и задержка от нажатия до его обработки.
+ *
+ * @param sim Указатель на структуру потока игры.
+ * @return int64_t Наносекунды до следующего такта или -1, если игра не идет
+ * и следующий шаг нужен только после ввода.
+ */
+int64_t tetrisSimRun(TetrisSim_t *sim) {
+  Tetris *game = sim->game;
+  SimInput_t input;
+  bool handled = false;
+  while (simQueuePop(&sim->thread.input, &input)) {
+    if (game->gameInfo.pause != STARTED) tickSkip(&sim->ticks, tickNow());
+    userInput(game, (UserAction_t)input.action, input.hold);
+    handled = true;
+  }
+  int64_t now = tickNow();
+  if (handled && sim->latency) latencyKeyApplied(sim->latency, now);
+  if (game->gameInfo.pause == STARTED) {
+    tickSetPeriod(&sim->ticks, gravityPeriodNs(game));
+    for (int steps = tickAdvance(&sim->ticks, now); steps > 0; steps--) {
+      int64_t start = sim->latency ? tickNow() : 0;
+      updateCurrentState(game);
+      if (sim->latency) latencyRecord(&sim->latency->tick, tickNow() - start);
+    }
+  } else {
+    tickSkip(&sim->ticks, now);
+  }
+  tetrisSimPublish(sim);
+  return game->gameInfo.pause == STARTED
+             ? tickUntilNext(&sim->ticks, tickNow())
+             : -1;
+}
+
+/**
+ * @brief Последний опубликованный кадр.
+ *
+ * Вызывается только потоком отрисовки. Кадр не меняется до следующего
+ * вызова tetrisSimFrame.
+ *
+ * @param sim Указатель на структуру потока игры.
+ * @return const TetrisFrame_t* Кадр (до первой публикации - пустой кадр с
+ * номером 0).
+ */
+const TetrisFrame_t *tetrisSimFrame(TetrisSim_t *sim) {
+  simFramesAcquire(&sim->frames);
+  return &sim->slots[sim->frames.front];
+}
+
+/**
+ * @brief Изменения кадра по сравнению с показанным ранее.
+ *
+ * @param frame Кадр.
+ * @param shown Номер кадра, который сейчас на экране.
+ * @return FrameDiff_t Строки поля и значения панели, изменившиеся в
+ * публикациях после shown.
+ */
+FrameDiff_t tetrisFrameChanges(const TetrisFrame_t *frame, uint64_t shown) {
+  FrameDiff_t diff = {0, 0};
+  for (int i = 0; i < HEIGHT; i++) {
+    if (frame->rowSequence[i] > shown) diff.rows |= 1u << i;
+  }
+  for (int k = 0; k < FRAME_HUD_ITEMS; k++) {
+    if (frame->hudSequence[k] > shown) diff.hud |= 1 << k;
+  }
+  return diff;
+}
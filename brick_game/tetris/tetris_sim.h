@@ -0,0 +1,68 @@
+#ifndef CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_SIM_H_
+#define CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_SIM_H_
+
+#include "../common/latency.h"
+#include "../common/sim_thread.h"
+#include "../common/tick_scheduler.h"
+#include "tetris_backend.h"
+
+/**
+ * @defgroup TetrisSim Tetris Simulation
+ * Игра Tetris в отдельном потоке с передачей кадров фронтенду.
+ *
+ * Поток игры обрабатывает ввод из очереди, выполняет такты гравитации по
+ * планировщику тактов и публикует самодостаточные кадры через тройной буфер
+ * (CommonSimThread). Фронтенд читает кадр без блокировок и не обращается к
+ * структуре Tetris, пока поток работает. Если поток не запущен, фронтенд
+ * сам вызывает tetrisSimRun по таймеру.
+ * @ingroup TetrisGame
+ * @{
+ */
+
+/**
+ * @brief Кадр игры для отрисовки.
+ *
+ * Номера публикаций строк и панели позволяют перерисовать только то, что
+ * изменилось после показанного кадра, даже если промежуточные кадры
+ * пропущены.
+ */
+typedef struct {
+  int cells[HEIGHT][WIDTH];  ///< Цвета клеток поля вместе с текущей фигурой.
+  int next[4][4];            ///< Цвета клеток следующей фигуры.
+  FrameHud_t hud;            ///< Значения панели и статус игры.
+  uint64_t sequence;         ///< Номер публикации (0 - не опубликован).
+  /// Номер публикации, в которой последний раз изменилась строка поля
+  uint64_t rowSequence[HEIGHT];
+  /// Номер публикации, в которой последний раз изменилось значение панели
+  /// (индекс - номер бита FRAME_*)
+  uint64_t hudSequence[FRAME_HUD_ITEMS];
+} TetrisFrame_t;
+
+/**
+ * @brief Игра, ее поток и кадры.
+ */
+typedef struct {
+  Tetris *game;                     ///< Игра (принадлежит фронтенду).
+  TickScheduler_t ticks;            ///< Планировщик тактов гравитации.
+  SimThread_t thread;               ///< Поток игры и очередь ввода.
+  SimFrames_t frames;               ///< Тройной буфер кадров.
+  TetrisFrame_t slots[SIM_FRAMES];  ///< Кадры тройного буфера.
+  uint64_t sequence;                ///< Номер последней публикации.
+  void (*notify)(void *context);    ///< Уведомление о новом кадре.
+  void *context;                    ///< Аргумент notify.
+  /// Гистограммы тактов и обработки ввода (NULL - не измерять)
+  LatencyStats_t *latency;
+} TetrisSim_t;
+
+void tetrisSimInit(TetrisSim_t *sim, Tetris *game,
+                   void (*notify)(void *context), void *context);
+bool tetrisSimStart(TetrisSim_t *sim);
+void tetrisSimStop(TetrisSim_t *sim);
+bool tetrisSimInput(TetrisSim_t *sim, UserAction_t action, bool hold);
+int64_t tetrisSimRun(TetrisSim_t *sim);
+const TetrisFrame_t *tetrisSimFrame(TetrisSim_t *sim);
+FrameDiff_t tetrisFrameChanges(const TetrisFrame_t *frame, uint64_t shown);
+
+/** @} */  // TetrisSim
+
+#endif  // CPP3_BRICKGAME_SRC_BRICK_GAME_TETRIS_TETRIS_SIM_H_
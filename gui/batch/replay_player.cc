@@ -0,0 +1,123 @@
+#include "replay_player.h"
+
+namespace s21 {
+
+/**
+ * @brief Воспроизводит запись партии Tetris.
+ *
+ * @param replay Запись партии.
+ * @param result Итог воспроизведения.
+ * @return bool true, если запись воспроизведена целиком.
+ */
+bool PlayTetris(const Replay_t &replay, ReplayResult &result) {
+  Tetris game;
+  bool played = initialGameSeeded(&game, replay.seed) == OK_;
+  if (played) {
+    ReplayCursor_t cursor{};
+    ReplayEvent_t event;
+    uint64_t tick = 0;
+    while (replayNext(&replay, &cursor, &event)) {
+      for (; tick < event.tick; tick++) updateCurrentState(&game);
+      userInput(&game, static_cast<::UserAction_t>(event.action), event.hold);
+    }
+    for (; tick < replay.ticks; tick++) updateCurrentState(&game);
+    played = cursor.offset == replay.size && cursor.events == replay.events;
+    result.score = game.gameInfo.score;
+    result.ticks = tick;
+    freeSpace(&game);
+  }
+  return played;
+}
+
+/**
+ * @brief Воспроизводит запись партии Snake.
+ *
+ * Модель создается без файла рекорда: воспроизведение не меняет рекорд
+ * пользователя.
+ *
+ * @param replay Запись партии.
+ * @param result Итог воспроизведения.
+ * @return bool true, если запись воспроизведена целиком.
+ */
+bool PlaySnake(const Replay_t &replay, ReplayResult &result) {
+  Snake game(replay.seed, nullptr);
+  Controller controller(&game);
+  bool played = !game.GetFlagErrorGame();
+  if (played) {
+    ReplayCursor_t cursor{};
+    ReplayEvent_t event;
+    uint64_t tick = 0;
+    while (replayNext(&replay, &cursor, &event)) {
+      for (; tick < event.tick; tick++) controller.Step();
+      controller.userInput(static_cast<UserAction_t>(event.action),
+                           event.hold);
+    }
+    for (; tick < replay.ticks; tick++) controller.Step();
+    played = cursor.offset == replay.size && cursor.events == replay.events;
+    result.score = game.gameInfo.score;
+    result.ticks = tick;
+  }
+  return played;
+}
+
+/**
+ * @brief Загружает и воспроизводит файл записи, сверяя итоговый счет.
+ *
+ * @param path Путь к файлу записи.
+ * @param result Итог воспроизведения.
+ * @return bool true, если запись воспроизведена и счет совпал.
+ */
+bool PlayReplayFile(const char *path, ReplayResult &result) {
+  Replay_t replay;
+  result = ReplayResult{};
+  bool played = replayLoad(&replay, path);
+  if (played) {
+    result.game = replay.game;
+    result.seed = replay.seed;
+    result.events = replay.events;
+    result.bytes = REPLAY_HEADER_SIZE + replay.size;
+    result.recordedScore = replay.score;
+    auto start = std::chrono::steady_clock::now();
+    if (replay.game == REPLAY_TETRIS) {
+      played = PlayTetris(replay, result);
+    } else if (replay.game == REPLAY_SNAKE) {
+      played = PlaySnake(replay, result);
+    } else {
+      played = false;
+    }
+    result.micros = std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    replayFree(&replay);
+  }
+  result.loaded = played;
+  return played && result.score == result.recordedScore;
+}
+
+}  // namespace s21
+
+int main(int argc, char **argv) {
+  int failed = 0;
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s replay.bgr...\n", argv[0]);
+    failed = 1;
+  }
+  for (int i = 1; i < argc; i++) {
+    s21::ReplayResult result;
+    bool ok = s21::PlayReplayFile(argv[i], result);
+    if (!result.loaded) {
+      printf("%s: cannot replay\n", argv[i]);
+    } else {
+      printf(
+          "%s: %s seed %llu, %u events, %llu ticks, %zu bytes, score %d "
+          "(recorded %d) %s in %.0f us\n",
+          argv[i], result.game == REPLAY_TETRIS ? "tetris" : "snake",
+          static_cast<unsigned long long>(result.seed), result.events,
+          static_cast<unsigned long long>(result.ticks), result.bytes,
+          result.score, result.recordedScore, ok ? "OK" : "MISMATCH",
+          result.micros);
+    }
+    failed += !ok;
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+#ifndef CPP3_BRICKGAME_SRC_GUI_BATCH_REPLAY_PLAYER_H_
+#define CPP3_BRICKGAME_SRC_GUI_BATCH_REPLAY_PLAYER_H_
+
+#include <chrono>
+#include <cstdio>
+
+#include "../../brick_game/snake/controller/controller.h"
+#include "../../brick_game/tetris/tetris_backend.h"
+
+namespace s21 {
+
+/**
+ * @brief Итог воспроизведения записи партии.
+ * @ingroup CommonReplay
+ */
+struct ReplayResult {
+  bool loaded = false;    ///< Запись прочитана и воспроизведена целиком.
+  int game = 0;           ///< Игра: REPLAY_TETRIS или REPLAY_SNAKE.
+  uint64_t seed = 0;      ///< Зерно партии.
+  uint32_t events = 0;    ///< Количество событий ввода.
+  uint64_t ticks = 0;     ///< Воспроизведено тактов.
+  size_t bytes = 0;       ///< Размер файла записи.
+  int score = 0;          ///< Счет после воспроизведения.
+  int recordedScore = 0;  ///< Счет, сохраненный в записи.
+  double micros = 0;      ///< Время воспроизведения в микросекундах.
+};
+
+bool PlayTetris(const Replay_t &replay, ReplayResult &result);
+bool PlaySnake(const Replay_t &replay, ReplayResult &result);
+bool PlayReplayFile(const char *path, ReplayResult &result);
+
+}  // namespace s21
+
+#endif  // CPP3_BRICKGAME_SRC_GUI_BATCH_REPLAY_PLAYER_H_
@@ -0,0 +1,72 @@
+#include <unistd.h>
+
+#include "../../brick_game/tetris/tetris_batch.h"
+
+/**
+ * @brief Выводит справку по параметрам командной строки.
+ */
+static void printUsage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [-n games] [-j threads] [-s seed] [-t max_ticks]\n"
+          "          [-p bot|random|idle] [-o results.csv]\n",
+          program);
+}
+
+int main(int argc, char **argv) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  BatchConfig_t config = {BATCH_DEFAULT_GAMES,
+                          cores > 0 ? (int)cores : 1,
+                          1,
+                          BATCH_DEFAULT_MAX_TICKS,
+                          findPolicy("bot"),
+                          NULL};
+  int flag = OK_;
+  int option;
+  while ((option = getopt(argc, argv, "n:j:s:t:p:o:")) != -1 && flag == OK_) {
+    switch (option) {
+      case 'n':
+        config.games = strtoll(optarg, NULL, 10);
+        break;
+      case 'j':
+        config.threads = atoi(optarg);
+        break;
+      case 's':
+        config.seed = strtoull(optarg, NULL, 10);
+        break;
+      case 't':
+        config.maxTicks = strtoull(optarg, NULL, 10);
+        break;
+      case 'p':
+        config.policy = findPolicy(optarg);
+        break;
+      case 'o':
+        config.csvPath = optarg;
+        break;
+      default:
+        flag = ERROR;
+        break;
+    }
+  }
+  if (flag != OK_ || optind != argc || config.games <= 0 ||
+      config.threads <= 0 || !config.policy) {
+    printUsage(argv[0]);
+    flag = ERROR;
+  }
+
+  GameResult_t *results = NULL;
+  if (flag == OK_) {
+    results = (GameResult_t *)calloc(config.games, sizeof(GameResult_t));
+    flag = results ? OK_ : ERROR;
+  }
+  if (flag == OK_) {
+    BatchTotals_t totals;
+    flag = runBatch(&config, results, &totals);
+    printReport(stdout, &config, results, &totals);
+    if (config.csvPath && writeResults(config.csvPath, &config, results)) {
+      fprintf(stderr, "cannot write %s\n", config.csvPath);
+      flag = ERROR;
+    }
+  }
+  free(results);
+  return flag == OK_ ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include "console_loop.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+/**
+ * @brief Создает таймер такта и готовит набор дескрипторов для poll.
+ *
+ * @param loop Указатель на цикл.
+ * @return true Если таймер создан.
+ */
+bool consoleLoopInit(ConsoleLoop_t *loop) {
+  memset(loop, 0, sizeof(*loop));
+  loop->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  loop->fds[0].fd = STDIN_FILENO;
+  loop->fds[0].events = POLLIN;
+  loop->fds[1].fd = loop->timerFd;
+  loop->fds[1].events = POLLIN;
+  return loop->timerFd >= 0;
+}
+
+/**
+ * @brief Закрывает таймер такта.
+ *
+ * @param loop Указатель на цикл.
+ */
+void consoleLoopFree(ConsoleLoop_t *loop) {
+  if (loop->timerFd >= 0) close(loop->timerFd);
+  loop->timerFd = -1;
+}
+
+/**
+ * @brief Взводит таймер на следующий такт или снимает его.
+ *
+ * @param loop Указатель на цикл.
+ * @param delayNs Время до такта; отрицательное значение снимает таймер
+ * (ждать только ввода).
+ */
+void consoleLoopArm(ConsoleLoop_t *loop, int64_t delayNs) {
+  struct itimerspec spec;
+  memset(&spec, 0, sizeof(spec));
+  if (delayNs >= 0) {
+    // Нулевое значение снимает timerfd, поэтому ближайший такт - через 1 нс.
+    if (delayNs == 0) delayNs = 1;
+    spec.it_value.tv_sec = delayNs / 1000000000LL;
+    spec.it_value.tv_nsec = delayNs % 1000000000LL;
+  }
+  timerfd_settime(loop->timerFd, 0, &spec, NULL);
+}
+
+/**
+ * @brief Спит до ввода, срабатывания таймера или сигнала.
+ *
+ * @param loop Указатель на цикл.
+ * @return int Маска событий CONSOLE_INPUT, CONSOLE_TICK, CONSOLE_SIGNAL
+ * (poll прерван сигналом, например SIGWINCH).
+ */
+int consoleLoopWait(ConsoleLoop_t *loop) {
+  int events = 0;
+  if (poll(loop->fds, 2, -1) < 0) {
+    events = errno == EINTR ? CONSOLE_SIGNAL : 0;
+  } else {
+    if (loop->fds[0].revents) events |= CONSOLE_INPUT;
+    if (loop->fds[1].revents & POLLIN) {
+      uint64_t expirations;
+      if (read(loop->timerFd, &expirations, sizeof(expirations)) > 0) {
+        events |= CONSOLE_TICK;
+      }
+    }
+  }
+  return events;
+}
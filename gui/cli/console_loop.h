@@ -0,0 +1,44 @@
+#ifndef CPP3_BRICKGAME_SRC_GUI_CLI_CONSOLE_LOOP_H_
+#define CPP3_BRICKGAME_SRC_GUI_CLI_CONSOLE_LOOP_H_
+#define CONSOLE_INPUT 1
+#define CONSOLE_TICK 2
+#define CONSOLE_SIGNAL 4
+
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup ConsoleLoop Console Event Loop
+ * Ожидание событий консольных фронтендов без опроса по таймауту.
+ *
+ * Цикл спит в poll() на stdin и timerfd, взведенном на момент следующего
+ * такта игры. Ввод обрабатывается сразу по приходу, на паузе таймер снят и
+ * процесс не просыпается до нажатия клавиши.
+ * @{
+ */
+
+/**
+ * @brief Источники событий консольного цикла.
+ */
+typedef struct {
+  struct pollfd fds[2];  ///< stdin и timerfd.
+  int timerFd;           ///< Таймер следующего такта.
+} ConsoleLoop_t;
+
+bool consoleLoopInit(ConsoleLoop_t *loop);
+void consoleLoopFree(ConsoleLoop_t *loop);
+void consoleLoopArm(ConsoleLoop_t *loop, int64_t delayNs);
+int consoleLoopWait(ConsoleLoop_t *loop);
+
+/** @} */  // ConsoleLoop
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP3_BRICKGAME_SRC_GUI_CLI_CONSOLE_LOOP_H_
@@ -17,8 +17,9 @@ bool startChoosedGame(int *choosedPoint) {
     Controller controller(&game);
     SnakeConsole snakeConsole(&controller);
     if (!game.GetFlagErrorGame()) {
+      controller.StartRecording();
       snakeConsole.start();
-
+      controller.SaveReplay(REPLAY_DIR);
     } else {
       flag = true;
     }
@@ -106,6 +107,7 @@ int main() {
   srand((unsigned)time(NULL));
 
   s21::initializeNcurses();
+  traceInstall(TRACE_FILE);
   while (choosedPoint != -1) {
     if (s21::handleInputMenu(&choosedPoint)) {
       mvprintw(2, 2, "%s", "Error while allocating memory for the game");
@@ -2,8 +2,13 @@
 namespace s21 {
 /**
  * @brief Конструктор класса SnakeConsole
+ *
+ * Контроллер записывает длительность шагов и задержку ввода в гистограммы
+ * консоли.
  */
 SnakeConsole::SnakeConsole(Controller *controller) : controller(controller) {
+  latencyStatsInit(&latency_);
+  controller->SetLatency(&latency_);
   start_color();
   init_pair(11, COLOR_RED, COLOR_RED);
   init_pair(15, COLOR_BLUE, COLOR_BLACK);
@@ -15,28 +20,55 @@ SnakeConsole::SnakeConsole(Controller *controller) : controller(controller) {
 /**
  * @brief Деструктор класса SnakeConsole
  */
-SnakeConsole::~SnakeConsole() noexcept { printf("\033[H\033[J"); }
+SnakeConsole::~SnakeConsole() noexcept {
+  controller->SetLatency(nullptr);
+  printf("\033[H\033[J");
+}
 
 /**
  * @brief Основная функция работы класса
+ *
+ * Цикл спит до нажатия клавиши или следующего шага змейки (ConsoleLoop) и
+ * после ввода или шага перерисовывает только изменившиеся строки и значения
+ * (DrawChanges). На паузе таймер снят. Длительность шагов и отрисовки и
+ * задержка ввода записываются в гистограммы (клавиша L показывает их на
+ * панели) и при выходе дописываются в LATENCY_FILE.
  */
 void SnakeConsole::start() {
-  while (controller->game->gameInfo.pause == NOT_STARTED) {
-    mvprintw(6, 2, "GAME READY");
-    mvprintw(8, 5, "Press ENTER");
-    mvprintw(10, 8, "to Start");
-    HandleInput();
-    Draw();
+  ConsoleLoop_t loop;
+  if (!consoleLoopInit(&loop)) {
+    endwin();
+    return;
   }
-
-  while (controller->game->gameInfo.pause != QUIT) {
-    timeout(50);
-    HandleInput();
-    if (controller->game->gameInfo.pause == STARTED) {
-      controller->updateCurrentState();
+  timeout(0);
+  Draw();
+  wnoutrefresh(stdscr);
+  doupdate();
+  while (controller->Snapshot().info.pause != QUIT) {
+    int events = consoleLoopWait(&loop);
+    bool changed = (events & (CONSOLE_TICK | CONSOLE_SIGNAL)) != 0;
+    bool overlay = latency_.overlay;
+    if (events & CONSOLE_INPUT) {
+      latencyKeyPressed(&latency_, tickNow());
+      changed = HandleInput() || changed;
+      latencyKeyApplied(&latency_, tickNow());
+    }
+    GameInfo_t info = controller->updateCurrentState();
+    consoleLoopArm(&loop,
+                   info.pause == STARTED ? controller->UntilNextTickNs() : -1);
+    if (changed) {
+      int64_t start = tickNow();
+      if ((events & CONSOLE_SIGNAL) || overlay != latency_.overlay) Draw();
+      DrawChanges();
+      if (latency_.overlay) DrawLatency();
+      wnoutrefresh(stdscr);
+      doupdate();
+      latencyRecord(&latency_.paint, tickNow() - start);
     }
-    Draw();
   }
+  timeout(timet);
+  consoleLoopFree(&loop);
+  latencyDump(&latency_, "snake", LATENCY_FILE);
   endwin();
 }
 
@@ -69,41 +101,39 @@ void SnakeConsole::InitialGamebar() {
 }
 
 /**
- * @brief Отрисовывает текущее состояние игры
+ * @brief Полностью перерисовывает экран по последнему снимку.
  *
+ * Нужна для первого кадра, после смены статуса и изменения размера
+ * терминала. Экран очищается через erase, а не clear, чтобы ncurses
+ * отправил в терминал только отличия от прежнего содержимого.
  */
 void SnakeConsole::Draw() {
-  clear();
+  ALLOC_PHASE(ALLOC_RENDER);
+  TRACE_SPAN("SnakeConsole::Draw");
+  const SnakeSnapshot &state = controller->Snapshot();
+  shownSequence_ = state.sequence;
+  erase();
   printRectangle(0, 21, 0, 21);
   printRectangle(0, 21, 21, 38);
   InitialGamebar();
-  mvprintw(7, 31, "%d", controller->game->gameInfo.high_score);
-  mvprintw(10, 31, "%d", controller->game->gameInfo.score);
-  mvprintw(14, 31, "%d", controller->game->gameInfo.level);
-
-  for (int i = 0; i < HEIGHT; i++) {
-    for (int j = 0; j < WIDTH; j++) {
-      if (controller->game->gameInfo.field[i][j] != 0) {
-        attron(COLOR_PAIR(controller->game->gameInfo.field[i][j]));
-        mvaddch(i + 1, j * 2 + 1, ACS_CKBOARD);
-        mvaddch(i + 1, j * 2 + 2, ACS_CKBOARD);
-        attroff(COLOR_PAIR(controller->game->gameInfo.field[i][j]));
-      }
-    }
-  }
-  DrawApple();
-  DrawSnake();
-  if (controller->game->gameInfo.pause == LOSED) {
+  DrawHud(state, FRAME_HUD_ALL);
+  for (int i = 0; i < HEIGHT; i++) DrawRow(state, i);
+  if (state.info.pause == LOSED) {
     mvprintw(9, 7, "GAME OVER!");
 
     mvprintw(2, 26, "GAME OVER");
   }
 
-  if (controller->game->gameInfo.pause == WIN) {
+  if (state.info.pause == WIN) {
     mvprintw(8, 3, "Congratulations!");
     mvprintw(2, 26, "YOU WIN");
   }
-  if (controller->game->gameInfo.pause == PAUSED) {
+  if (state.info.pause == NOT_STARTED) {
+    mvprintw(6, 2, "GAME READY");
+    mvprintw(8, 5, "Press ENTER");
+    mvprintw(10, 8, "to Start");
+  }
+  if (state.info.pause == PAUSED) {
     mvprintw(2, 25, "GAME PAUSED");
     mvprintw(8, 3, "Press P Key");
     mvprintw(10, 7, "to Continue");
@@ -111,41 +141,133 @@ void SnakeConsole::Draw() {
 }
 
 /**
- * @brief Обрабатывает пользовательский ввод для управления игрой.
+ * @brief Перерисовывает строки и значения панели, изменившиеся после
+ * показанного снимка.
  *
+ * При смене статуса игры выполняется полная перерисовка Draw.
  */
-void SnakeConsole::HandleInput() {
-  int ch = getch();
-  switch (ch) {
-    case 'q':
-      controller->userInput(Terminate, 0);
-      break;
-    case 'p':
-      controller->userInput(Pause, 0);
-      break;
-    case KEY_LEFT:
-      controller->userInput(Left, 0);
-      break;
-    case KEY_RIGHT:
-      controller->userInput(Right, 0);
-      break;
-    case KEY_UP:
-      controller->userInput(Up, 0);
-      break;
-    case KEY_DOWN:
-      controller->userInput(Down, 0);
-      break;
-    case 'r':
-      controller->userInput(Action, true);
-      break;
-    case '\n':
-      controller->userInput(Start, 0);
-      break;
-    default:
-      break;
+void SnakeConsole::DrawChanges() {
+  ALLOC_PHASE(ALLOC_RENDER);
+  TRACE_SPAN("SnakeConsole::DrawChanges");
+  const SnakeSnapshot &state = controller->Snapshot();
+  FrameDiff_t diff = state.ChangesSince(shownSequence_);
+  if (diff.hud & FRAME_STATE) {
+    Draw();
+  } else {
+    shownSequence_ = state.sequence;
+    for (uint32_t rows = diff.rows; rows; rows &= rows - 1) {
+      DrawRow(state, __builtin_ctz(rows));
+    }
+    DrawHud(state, diff.hud);
   }
 }
 
+/**
+ * @brief Отрисовывает одну строку поля: клетки, яблоко и змейку.
+ *
+ * @param state Снимок состояния игры.
+ * @param i Номер строки поля.
+ */
+void SnakeConsole::DrawRow(const SnakeSnapshot &state, int i) {
+  int colors[WIDTH];
+  for (int j = 0; j < WIDTH; j++) colors[j] = state.info.field[i][j];
+  if (state.apple[1] == i && state.apple[0] >= 0 && state.apple[0] < WIDTH) {
+    colors[state.apple[0]] = 11;
+  }
+  for (size_t k = state.length; k-- > 0;) {
+    const Snake::SnakeElement &segment = state.body[k];
+    if (segment.y == i && segment.x >= 0 && segment.x < WIDTH) {
+      colors[segment.x] = k ? 14 : 15;
+    }
+  }
+  for (int j = 0; j < WIDTH; j++) {
+    if (colors[j] != 0) {
+      attron(COLOR_PAIR(colors[j]));
+      mvaddch(i + 1, j * 2 + 1, ACS_CKBOARD);
+      mvaddch(i + 1, j * 2 + 2, ACS_CKBOARD);
+      attroff(COLOR_PAIR(colors[j]));
+    } else {
+      mvaddstr(i + 1, j * 2 + 1, "  ");
+    }
+  }
+}
+
+/**
+ * @brief Выводит значения панели: рекорд, счет и уровень.
+ *
+ * @param state Снимок состояния игры.
+ * @param hud Маска FRAME_* значений, которые нужно вывести.
+ */
+void SnakeConsole::DrawHud(const SnakeSnapshot &state, int hud) {
+  if (hud & FRAME_HIGH_SCORE) mvprintw(7, 31, "%-6d", state.info.high_score);
+  if (hud & FRAME_SCORE) mvprintw(10, 31, "%-6d", state.info.score);
+  if (hud & FRAME_LEVEL) mvprintw(14, 31, "%-6d", state.info.level);
+}
+
+/**
+ * @brief Выводит перцентили задержек на место подписи внизу панели.
+ *
+ * Три строки: шаг змейки (T), отрисовка (P) и ввод (I), в каждой
+ * p50/p99/max.
+ */
+void SnakeConsole::DrawLatency() {
+  const LatencyHistogram_t *histograms[3] = {&latency_.tick, &latency_.paint,
+                                             &latency_.input};
+  const char labels[3] = {'T', 'P', 'I'};
+  for (int i = 0; i < 3; i++) {
+    char line[17];
+    latencySummary(histograms[i], labels[i], line, sizeof(line));
+    mvprintw(18 + i, 22, "%-16s", line);
+  }
+}
+
+/**
+ * @brief Обрабатывает все накопленные нажатия клавиш.
+ *
+ * Ввод читается без ожидания, пока getch не вернет ERR. Клавиша L
+ * включает и выключает оверлей задержек.
+ *
+ * @return true Если была прочитана хотя бы одна клавиша.
+ */
+bool SnakeConsole::HandleInput() {
+  bool handled = false;
+  for (int ch = getch(); ch != ERR; ch = getch()) {
+    handled = true;
+    switch (ch) {
+      case 'q':
+        controller->userInput(Terminate, 0);
+        break;
+      case 'p':
+        controller->userInput(Pause, 0);
+        break;
+      case KEY_LEFT:
+        controller->userInput(Left, 0);
+        break;
+      case KEY_RIGHT:
+        controller->userInput(Right, 0);
+        break;
+      case KEY_UP:
+        controller->userInput(Up, 0);
+        break;
+      case KEY_DOWN:
+        controller->userInput(Down, 0);
+        break;
+      case 'r':
+        controller->userInput(Action, true);
+        break;
+      case '\n':
+        controller->userInput(Start, 0);
+        break;
+      case 'l':
+        latency_.overlay = !latency_.overlay;
+        break;
+      default:
+        break;
+    }
+  }
+  return handled;
+}
+
 /**
  * @brief Инициализация консольного интерфейса.
  *
@@ -185,37 +307,4 @@ void printRectangle(int top_y, int bottom_y, int left_x, int right_x) {
   for (; i < right_x; i++) mvaddch(bottom_y, i, ACS_HLINE);
   mvaddch(bottom_y, i, ACS_LRCORNER);
 }
-
-/**
- * @brief Отрисовывает положение змейки
- *
- */
-void SnakeConsole::DrawSnake() {
-  std::vector snake = controller->game->snakeCoordinates;
-
-  for (size_t i = 1; i < snake.size(); ++i) {
-    attron(COLOR_PAIR(14));
-    mvaddch(snake[i].y + 1, snake[i].x * 2 + 1, ACS_CKBOARD);
-    mvaddch(snake[i].y + 1, snake[i].x * 2 + 2, ACS_CKBOARD);
-    attroff(COLOR_PAIR(14));
-  }
-  attron(COLOR_PAIR(15));
-  mvaddch(snake.front().y + 1, snake.front().x * 2 + 1, ACS_CKBOARD);
-  mvaddch(snake.front().y + 1, snake.front().x * 2 + 2, ACS_CKBOARD);
-  attroff(COLOR_PAIR(15));
-}
-
-/**
- * @brief Отрисовывает положение яблока
- *
- */
-void SnakeConsole::DrawApple() noexcept {
-  int appleX = controller->game->gameInfo.next[0][0];
-  int appleY = controller->game->gameInfo.next[0][1];
-
-  attron(COLOR_PAIR(11));
-  mvaddch(appleY + 1, appleX * 2 + 1, ACS_CKBOARD);
-  mvaddch(appleY + 1, appleX * 2 + 2, ACS_CKBOARD);
-  attroff(COLOR_PAIR(11));
-}
-}  // namespace s21
\ No newline at end of file
+}  // namespace s21
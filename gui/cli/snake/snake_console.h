@@ -10,6 +10,7 @@
 #include <unistd.h>
 
 #include "../../../brick_game/snake/controller/controller.h"
+#include "../console_loop.h"
 
 namespace s21 {
 void initializeNcurses();
@@ -28,11 +29,15 @@ class SnakeConsole {
 
  private:
   Controller *controller;  ///< Ссылка на объект класса Controller
+  uint64_t shownSequence_ = 0;  ///< Номер снимка, показанного на экране
+  LatencyStats_t latency_;  ///< Гистограммы шагов, отрисовки и ввода
   void Draw();
+  void DrawChanges();
+  void DrawLatency();
   void InitialGamebar();
-  void HandleInput();
-  void DrawSnake();
-  void DrawApple() noexcept;
+  bool HandleInput();
+  void DrawRow(const SnakeSnapshot &state, int i);
+  void DrawHud(const SnakeSnapshot &state, int hud);
 };
 
 }  // namespace s21
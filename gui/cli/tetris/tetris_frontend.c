@@ -4,6 +4,12 @@
  * @brief Инициализирует игру, обрабатывает ввод и выводит графику в игровом
  * цикле.
  *
+ * Цикл спит до нажатия клавиши или следующего такта гравитации (ConsoleLoop)
+ * и после ввода или такта перерисовывает только изменившиеся строки и
+ * значения (draw_changes). На паузе таймер снят. Длительность тактов и
+ * отрисовки и задержка ввода записываются в гистограммы (клавиша L
+ * показывает их на панели) и при выходе дописываются в LATENCY_FILE.
+ *
  * @return int Статус программы (0 - успех, 1 - ошибка).
  */
 int start() {
@@ -13,27 +19,64 @@ int start() {
   if (initialGame(&game) == ERROR) {
     return 1;
   }
-  double counter = 1;
-
-  while (game.gameInfo.pause == NOT_STARTED) {
-    mvprintw(6, 2, "GAME READY");
-    mvprintw(8, 5, "Press ENTER");
-    mvprintw(10, 8, "to Start");
-    handleInput(&game);
-    draw(&game);
+  attachHighScoreFile(&game);
+  Replay_t replay;
+  recordReplay(&game, &replay);
+  TickScheduler_t ticks;
+  LatencyStats_t latency;
+  ConsoleLoop_t loop;
+  if (!consoleLoopInit(&loop)) {
+    replayFree(&replay);
+    clearField(&game);
+    endwin();
+    return 1;
   }
 
+  timeout(0);
+  latencyStatsInit(&latency);
+  tickInit(&ticks, gravityPeriodNs(&game), tickNow());
+  draw(&game);
+  wnoutrefresh(stdscr);
+  doupdate();
   while (game.gameInfo.pause != QUIT) {
-    handleInput(&game);
+    int events = consoleLoopWait(&loop);
+    int64_t now = tickNow();
+    bool changed = (events & CONSOLE_SIGNAL) != 0;
+    bool overlay = latency.overlay;
+    if (events & CONSOLE_INPUT) {
+      latencyKeyPressed(&latency, now);
+      changed = handleInput(&game, &latency) || changed;
+      now = tickNow();
+      latencyKeyApplied(&latency, now);
+    }
     if (game.gameInfo.pause == STARTED) {
-      if (counter >= (1.55 - game.speed * SPEED_RATE)) {
+      tickSetPeriod(&ticks, gravityPeriodNs(&game));
+      for (int steps = tickAdvance(&ticks, now); steps > 0; steps--) {
+        int64_t start = tickNow();
         updateCurrentState(&game);
-        counter = 0.0;
+        latencyRecord(&latency.tick, tickNow() - start);
+        changed = true;
       }
-      counter += READ_DELAY * 0.001;
+      consoleLoopArm(&loop, tickUntilNext(&ticks, now));
+    } else {
+      tickSkip(&ticks, now);
+      consoleLoopArm(&loop, -1);
+    }
+    if (changed) {
+      int64_t start = tickNow();
+      if ((events & CONSOLE_SIGNAL) || overlay != latency.overlay) draw(&game);
+      draw_changes(&game);
+      if (latency.overlay) draw_latency(&latency);
+      wnoutrefresh(stdscr);
+      doupdate();
+      latencyRecord(&latency.paint, tickNow() - start);
     }
-    draw(&game);
   }
+  timeout(timet);
+  consoleLoopFree(&loop);
+  latencyDump(&latency, "tetris", LATENCY_FILE);
+  replayArchive(&replay, REPLAY_DIR, game.gameInfo.score);
+  replayFree(&replay);
   clearField(&game);
   endwin();
   return 0;
@@ -100,36 +143,36 @@ void initialGamebar() {
 }
 
 /**
- * @brief Отрисовывает текущее состояние игры, включая зафиксированные фигуры на
- * поле и игровую панель.
+ * @brief Полностью перерисовывает экран: рамки, панель, поле и надписи
+ * статуса.
+ *
+ * Нужна для первого кадра, после смены статуса и изменения размера
+ * терминала. Экран очищается через erase, а не clear, чтобы ncurses
+ * отправил в терминал только отличия от прежнего содержимого.
  *
  * @param game Указатель на структуру Tetris.
  */
 void draw(Tetris *game) {
-  clear();
-  draw_next(game);
+  ALLOC_PHASE(ALLOC_RENDER);
+  TRACE_SPAN("draw");
+  getGameInfo(game);
+  takeFrameDiff(game);
+  erase();
   print_rectangle(0, 21, 0, 21);
   print_rectangle(0, 21, 21, 38);
   initialGamebar();
-  mvprintw(10, 31, "%d", game->gameInfo.high_score);
-  mvprintw(13, 31, "%d", game->gameInfo.score);
-  mvprintw(16, 31, "%d", game->gameInfo.level);
-
-  for (int i = 0; i < HEIGHT; i++) {
-    for (int j = 0; j < WIDTH; j++) {
-      if (game->gameInfo.field[i][j] != 0) {
-        attron(COLOR_PAIR(game->gameInfo.field[i][j]));
-        mvaddch(i + 1, j * 2 + 1, ACS_CKBOARD);
-        mvaddch(i + 1, j * 2 + 2, ACS_CKBOARD);
-        attroff(COLOR_PAIR(game->gameInfo.field[i][j]));
-      }
-    }
-  }
+  draw_next(game);
+  draw_hud(game, FRAME_HUD_ALL);
+  for (int i = 0; i < HEIGHT; i++) draw_row(game, i);
 
   if (game->gameInfo.pause == ENDED) {
     mvprintw(2, 26, "GAME OVER");
-  } else {
-    draw_figure(game);
+  }
+
+  if (game->gameInfo.pause == NOT_STARTED) {
+    mvprintw(6, 2, "GAME READY");
+    mvprintw(8, 5, "Press ENTER");
+    mvprintw(10, 8, "to Start");
   }
 
   if (game->gameInfo.pause == PAUSED) {
@@ -140,25 +183,74 @@ void draw(Tetris *game) {
 }
 
 /**
- * @brief Отрисовывает текущую фигуру на игровом поле.
+ * @brief Перерисовывает только то, что изменилось с предыдущего кадра.
+ *
+ * Рамки и подписи панели не трогаются; при смене статуса игры выполняется
+ * полная перерисовка draw.
  *
  * @param game Указатель на структуру Tetris.
  */
-void draw_figure(Tetris *game) {
-  for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 4; j++) {
-      if (game->figure.shape[i][j] == 1 && game->figure.y + i >= 0) {
-        attron(COLOR_PAIR(game->figure.indexTetramino % 7 + 1));
-        mvaddch((game->figure.y + i) + 1, (game->figure.x + j) * 2 + 1,
-                ACS_CKBOARD);
-        mvaddch((game->figure.y + i) + 1, (game->figure.x + j) * 2 + 2,
-                ACS_CKBOARD);
-        attroff(COLOR_PAIR(game->figure.indexTetramino % 7 + 1));
+void draw_changes(Tetris *game) {
+  ALLOC_PHASE(ALLOC_RENDER);
+  TRACE_SPAN("draw_changes");
+  getGameInfo(game);
+  FrameDiff_t diff = takeFrameDiff(game);
+  if (diff.hud & FRAME_STATE) {
+    draw(game);
+  } else {
+    for (uint32_t rows = diff.rows; rows; rows &= rows - 1) {
+      draw_row(game, __builtin_ctz(rows));
+    }
+    if (diff.hud & FRAME_NEXT) draw_next(game);
+    draw_hud(game, diff.hud);
+  }
+}
 
-        attroff(game->figure.indexTetramino % 7 + 1);
+/**
+ * @brief Отрисовывает одну строку поля вместе с падающей фигурой.
+ *
+ * Пустые клетки закрашиваются пробелами, поэтому строку можно перерисовать
+ * поверх прежнего содержимого.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @param i Номер строки поля.
+ */
+void draw_row(Tetris *game, int i) {
+  int colors[WIDTH];
+  for (int j = 0; j < WIDTH; j++) colors[j] = game->gameInfo.field[i][j];
+  if (game->gameInfo.pause != ENDED) {
+    const Tetromino_t *t = &TETROMINOS[game->figure.indexTetramino];
+    for (int k = 0; k < 4; k++) {
+      int x = game->figure.x + t->cells[k][1];
+      if (game->figure.y + t->cells[k][0] == i && x >= 0 && x < WIDTH) {
+        colors[x] = PIECE_TYPE(game->figure.indexTetramino) + 1;
       }
     }
   }
+  for (int j = 0; j < WIDTH; j++) {
+    if (colors[j] != 0) {
+      attron(COLOR_PAIR(colors[j]));
+      mvaddch(i + 1, j * 2 + 1, ACS_CKBOARD);
+      mvaddch(i + 1, j * 2 + 2, ACS_CKBOARD);
+      attroff(COLOR_PAIR(colors[j]));
+    } else {
+      mvaddstr(i + 1, j * 2 + 1, "  ");
+    }
+  }
+}
+
+/**
+ * @brief Выводит значения панели: рекорд, счет и уровень.
+ *
+ * @param game Указатель на структуру Tetris.
+ * @param hud Маска FRAME_* значений, которые нужно вывести.
+ */
+void draw_hud(Tetris *game, int hud) {
+  if (hud & FRAME_HIGH_SCORE) {
+    mvprintw(10, 31, "%-6d", game->gameInfo.high_score);
+  }
+  if (hud & FRAME_SCORE) mvprintw(13, 31, "%-6d", game->gameInfo.score);
+  if (hud & FRAME_LEVEL) mvprintw(16, 31, "%-6d", game->gameInfo.level);
 }
 
 /**
@@ -178,6 +270,8 @@ void draw_next(Tetris *game) {
         mvaddch(m, n, ACS_CKBOARD);
         mvaddch(m, n + 1, ACS_CKBOARD);
         attroff(COLOR_PAIR(game->figure.indexNext % 7 + 1));
+      } else {
+        mvaddstr(m, n, "  ");
       }
       n += 2;
     }
@@ -188,35 +282,65 @@ void draw_next(Tetris *game) {
 }
 
 /**
- * @brief Обрабатывает пользовательский ввод для управления игрой.
+ * @brief Выводит перцентили задержек на место подписи внизу панели.
+ *
+ * Три строки: такт (T), отрисовка (P) и ввод (I), в каждой p50/p99/max.
+ *
+ * @param latency Указатель на гистограммы задержек.
+ */
+void draw_latency(const LatencyStats_t *latency) {
+  const LatencyHistogram_t *histograms[3] = {&latency->tick, &latency->paint,
+                                             &latency->input};
+  const char labels[3] = {'T', 'P', 'I'};
+  for (int i = 0; i < 3; i++) {
+    char line[17];
+    latencySummary(histograms[i], labels[i], line, sizeof(line));
+    mvprintw(18 + i, 22, "%-16s", line);
+  }
+}
+
+/**
+ * @brief Обрабатывает все накопленные нажатия клавиш.
+ *
+ * Ввод читается без ожидания, пока getch не вернет ERR. Клавиша L
+ * включает и выключает оверлей задержек.
  *
  * @param game Указатель на структуру Tetris.
+ * @param latency Указатель на гистограммы задержек.
+ * @return true Если была прочитана хотя бы одна клавиша.
  */
-void handleInput(Tetris *game) {
-  int ch = getch();
-  switch (ch) {
-    case 'q':
-      userInput(game, Terminate, 0);
-      break;
-    case 'p':
-      userInput(game, Pause, 0);
-      break;
-    case KEY_LEFT:
-      userInput(game, Left, 0);
-      break;
-    case KEY_RIGHT:
-      userInput(game, Right, 0);
-      break;
-    case 'r':
-      userInput(game, Action, 0);
-      break;
-    case KEY_DOWN:
-      userInput(game, Down, 0);
-      break;
-    case '\n':
-      userInput(game, Start, 0);
-      break;
+bool handleInput(Tetris *game, LatencyStats_t *latency) {
+  bool handled = false;
+  for (int ch = getch(); ch != ERR; ch = getch()) {
+    handled = true;
+    switch (ch) {
+      case 'q':
+        userInput(game, Terminate, 0);
+        break;
+      case 'p':
+        userInput(game, Pause, 0);
+        break;
+      case KEY_LEFT:
+        userInput(game, Left, 0);
+        break;
+      case KEY_RIGHT:
+        userInput(game, Right, 0);
+        break;
+      case 'r':
+        userInput(game, Action, 0);
+        break;
+      case KEY_DOWN:
+        userInput(game, Down, 0);
+        break;
+      case '\n':
+        userInput(game, Start, 0);
+        break;
+      case 'l':
+        latency->overlay = !latency->overlay;
+        break;
+    }
   }
+  return handled;
 }
 
 /**
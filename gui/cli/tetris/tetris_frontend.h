@@ -1,12 +1,14 @@
 
 #ifndef CPP3_BRICKGAME_SRC_GUI_CLI_TETRUS_TETRUS_FRONTEND_H_
 #define CPP3_BRICKGAME_SRC_GUI_CLI_TETRUS_TETRUS_FRONTEND_H
-#define SPEED_RATE 0.125
-#define READ_DELAY 50
 
+#include <ncurses.h>
 #include <time.h>
 
-#include "../../../brick_game/tetris/tetris_backend.h"
+#include "../../../brick_game/common/latency.h"
+#include "../../../brick_game/common/tick_scheduler.h"
+#include "../console_loop.h"
+#include "../../../brick_game/tetris/tetris_score.h"
 
 /**
  * @defgroup TetrisConsole Tetris Console
@@ -16,12 +18,15 @@
  */
 int start();
 void draw(Tetris *game);
+void draw_changes(Tetris *game);
+void draw_row(Tetris *game, int i);
+void draw_hud(Tetris *game, int hud);
 void print_rectangle(int top_y, int bottom_y, int left_x, int right_x);
 void initialGamebar();
 void initialize_ncurses();
-void draw_figure(Tetris *game);
 void draw_next(Tetris *game);
-void handleInput(Tetris *game);
+void draw_latency(const LatencyStats_t *latency);
+bool handleInput(Tetris *game, LatencyStats_t *latency);
 void init_colors();
 void clearField(Tetris *game);
 
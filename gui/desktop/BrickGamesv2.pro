@@ -13,6 +13,17 @@ SOURCES += \
     main.cc \
     snakeqt.cc \
     ../../brick_game/tetris/tetris_backend.c \
+    ../../brick_game/tetris/tetris_score.c \
+    ../../brick_game/tetris/tetris_sim.c \
+    ../../brick_game/common/alloc_stats.c \
+    ../../brick_game/common/latency.c \
+    ../../brick_game/common/field.c \
+    ../../brick_game/common/frame.c \
+    ../../brick_game/common/replay.c \
+    ../../brick_game/common/score_store.c \
+    ../../brick_game/common/sim_thread.c \
+    ../../brick_game/common/tick_scheduler.c \
+    ../../brick_game/common/trace.c \
     ../../brick_game/snake/controller/controller.cc \
     ../../brick_game/snake/model/snake.cc \
     tetrisqt.cc
@@ -23,7 +34,19 @@ HEADERS += \
     snakeqt.h \
     tetrisqt.h \
     ../../brick_game/tetris/tetris_backend.h \
+    ../../brick_game/tetris/tetris_score.h \
+    ../../brick_game/tetris/tetris_sim.h \
+    ../../brick_game/common/alloc_stats.h \
+    ../../brick_game/common/latency.h \
+    ../../brick_game/common/field.h \
+    ../../brick_game/common/frame.h \
+    ../../brick_game/common/replay.h \
+    ../../brick_game/common/score_store.h \
+    ../../brick_game/common/sim_thread.h \
+    ../../brick_game/common/tick_scheduler.h \
+    ../../brick_game/common/trace.h \
     ../../brick_game/snake/controller/controller.h \
+    ../../brick_game/snake/model/ring_buffer.h \
     ../../brick_game/snake/model/snake.h
 
 FORMS += \
@@ -2,11 +2,17 @@
 
 #include "ui_brickgame.h"
 
+/**
+ * @brief Конструктор главного меню.
+ *
+ * Окна игр не создаются: каждое создается при первом выборе игры
+ * (ButtonChosedCheck), поэтому меню запускается без моделей, таймеров и
+ * шрифтов игр.
+ *
+ * @param parent Указатель на родительский виджет (по умолчанию nullptr).
+ */
 BrickGame::BrickGame(QWidget *parent)
-    : QMainWindow(parent),
-      ui(new Ui::brickgame),
-      t(new s21::TetrisQT),
-      s(new s21::SnakeQT) {
+    : QMainWindow(parent), ui(new Ui::brickgame), t(nullptr), s(nullptr) {
   ui->setupUi(this);
 
   connect(ui->ButtonTetris, &QPushButton::clicked, this,
@@ -15,22 +21,57 @@ BrickGame::BrickGame(QWidget *parent)
           &BrickGame::ButtonChosedCheck);
   connect(ui->ButtonSnake, &QPushButton::clicked, this,
           &BrickGame::ButtonChosedCheck);
+}
+
+/**
+ * @brief Деструктор главного меню: удаляет созданные окна игр.
+ *
+ * Сигналы окон отключаются заранее: их деструкторы сообщают о закрытии
+ * игры, а меню в этот момент уже уничтожается.
+ */
+BrickGame::~BrickGame() {
+  if (t) t->disconnect(this);
+  if (s) s->disconnect(this);
+  delete t;
+  delete s;
+  delete ui;
+}
 
-  connect(t, &s21::TetrisQT::gameClosed, this, &BrickGame::show);
-  connect(s, &s21::SnakeQT::gameClosed, this, &BrickGame::show);
+/**
+ * @brief Окно Tetris, созданное при первом обращении.
+ *
+ * @return s21::TetrisQT* Окно Tetris.
+ */
+s21::TetrisQT *BrickGame::TetrisWindow() {
+  if (!t) {
+    t = new s21::TetrisQT;
+    connect(t, &s21::TetrisQT::gameClosed, this, &BrickGame::show);
+  }
+  return t;
 }
 
-BrickGame::~BrickGame() { delete ui; }
+/**
+ * @brief Окно Snake, созданное при первом обращении.
+ *
+ * @return s21::SnakeQT* Окно Snake.
+ */
+s21::SnakeQT *BrickGame::SnakeWindow() {
+  if (!s) {
+    s = new s21::SnakeQT;
+    connect(s, &s21::SnakeQT::gameClosed, this, &BrickGame::show);
+  }
+  return s;
+}
 
 void BrickGame::ButtonChosedCheck() {
   QPushButton *button = qobject_cast<QPushButton *>(sender());
 
   if (button == ui->ButtonSnake) {
     hide();
-    s->show();
+    SnakeWindow()->show();
   } else if (button == ui->ButtonTetris) {
     hide();
-    t->show();
+    TetrisWindow()->show();
   } else if (button == ui->ButtonExit) {
     close();
   }
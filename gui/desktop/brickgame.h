@@ -24,9 +24,12 @@ class BrickGame : public QMainWindow {
   void ButtonChosedCheck();
 
  private:
+  s21::TetrisQT *TetrisWindow();
+  s21::SnakeQT *SnakeWindow();
+
   Ui::brickgame *ui;
-  s21::TetrisQT *t;
-  s21::SnakeQT *s;
+  s21::TetrisQT *t;  ///< Окно Tetris (nullptr, пока игра не выбрана)
+  s21::SnakeQT *s;   ///< Окно Snake (nullptr, пока игра не выбрана)
   QPushButton *ButtonTetris;
   QPushButton *ButtonExit;
   QPushButton *ButtonSnake;
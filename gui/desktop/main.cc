@@ -4,6 +4,7 @@
 
 int main(int argc, char *argv[]) {
   QApplication a(argc, argv);
+  traceInstall(TRACE_FILE);
   BrickGame w;
   w.show();
   return a.exec();
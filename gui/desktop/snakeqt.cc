@@ -5,75 +5,122 @@ namespace s21 {
  * @brief Конструктор класса SnakeQT.
  *
  * Инициализирует окно игры SnakeQT, устанавливает размеры окна,
- * инициализирует таймер, обновляет значение флага ошибки
+ * инициализирует таймер. Модель и контроллер создаются при показе окна
+ * (ResetGame). Игра идет в потоке контроллера; таймер нужен, только если
+ * поток запустить не удалось. Таймер однократный: он взводится на момент
+ * следующего шага змейки и не работает, пока игра не идет или окно
+ * скрыто. Гистограммы задержек копятся, пока окно существует, и при
+ * закрытии приложения дописываются в LATENCY_FILE.
  *
  * @param parent Указатель на родительский виджет (по умолчанию nullptr).
  */
 SnakeQT::SnakeQT(QWidget *parent)
-    : QWidget(parent), timer_(nullptr), flagError_(0) {
-  srand(time(NULL));
+    : QWidget(parent),
+      controller_(nullptr),
+      timer_(nullptr),
+      flagError_(true) {
   setFixedSize(405, 440);
-  QString fontPath = ":/Snake Chan.ttf";
-  int fontId = QFontDatabase::addApplicationFont(fontPath);
-  if (fontId != -1) {
-    QStringList fontFamilies = QFontDatabase::applicationFontFamilies(fontId);
-    if (!fontFamilies.isEmpty()) {
-      QFont tetrisFont(fontFamilies.at(0));
-      setFont(tetrisFont);
-    }
-  } else {
-    qWarning() << "Не удалось загрузить шрифт";
-  }
+  const QString &fontFamily = GameFontFamily();
+  if (!fontFamily.isEmpty()) setFont(QFont(fontFamily));
+  overlayFont_ = font();
+  overlayFont_.setPointSizeF(overlayFont_.pointSizeF() * 1.5);
+  ::latencyStatsInit(&latency_);
+  timer_ = new QTimer(this);
+  timer_->setSingleShot(true);
+  timer_->setTimerType(Qt::PreciseTimer);
+  connect(timer_, &QTimer::timeout, this, &SnakeQT::UpdateGame);
+}
 
-  controller_ = new Controller(new s21::Snake()),
-  flagError_ = controller_->game->GetFlagErrorGame();
-  if (flagError_ != true) {
-    timer_ = new QTimer(this);
-    connect(timer_, &QTimer::timeout, this, &SnakeQT::UpdateGame);
-    timer_->start(1);
-  }
+/**
+ * @brief Семейство шрифта игры из ресурсов.
+ *
+ * Шрифт регистрируется в базе шрифтов приложения при первом вызове, один
+ * раз на все приложение, а не при каждом создании окна.
+ *
+ * @return const QString& Семейство шрифта (пустая строка, если шрифт
+ * загрузить не удалось).
+ */
+const QString &SnakeQT::GameFontFamily() {
+  static const QString family = [] {
+    int fontId = QFontDatabase::addApplicationFont(":/Snake Chan.ttf");
+    QStringList fontFamilies;
+    if (fontId != -1) {
+      fontFamilies = QFontDatabase::applicationFontFamilies(fontId);
+    } else {
+      qWarning() << "Не удалось загрузить шрифт";
+    }
+    return fontFamilies.isEmpty() ? QString() : fontFamilies.at(0);
+  }();
+  return family;
 }
 
 /**
  * @brief Деструктор класса SnakeQT.
  *
  * Освобождает память, используемую объектом SnakeQT,
- * и генерирует сигнал о закрытии игры.
+ * и генерирует сигнал о закрытии игры. Недоигранная партия сохраняется в
+ * архив записей, гистограммы задержек дописываются в LATENCY_FILE.
  */
-SnakeQT::~SnakeQT() { emit gameClosed(); }
+SnakeQT::~SnakeQT() {
+  emit gameClosed();
+  DestroyGame();
+  ::latencyDump(&latency_, "snake", LATENCY_FILE);
+}
+
+/**
+ * @brief Завершает текущую игру и освобождает контроллер и модель.
+ *
+ * Поток игры останавливается, недоигранная партия сохраняется в архив
+ * записей. Контроллер не владеет моделью, поэтому модель удаляется здесь.
+ */
+void SnakeQT::DestroyGame() {
+  if (controller_ != nullptr) {
+    StopSimulation();
+    controller_->SaveReplay(REPLAY_DIR);
+    delete controller_->game;
+    delete controller_;
+    controller_ = nullptr;
+    shown_ = nullptr;
+  }
+}
 
 /**
  * @brief Обработка нажатий клавиш.
  *
- * Эта функция вызывается при нажатии клавиш на клавиатуре.
+ * Эта функция вызывается при нажатии клавиш на клавиатуре. Клавиша L
+ * включает и выключает оверлей задержек.
  *
  * @param event Указатель на событие нажатия клавиши.
  */
 void SnakeQT::keyPressEvent(QKeyEvent *event) {
   switch (event->key()) {
     case Qt::Key_Escape:
-      controller_->userInput(Terminate, 0);
+      SendInput(Terminate, 0);
       break;
     case Qt::Key_P:
-      controller_->userInput(Pause, 0);
+      SendInput(Pause, 0);
       break;
     case Qt::Key_Left:
-      controller_->userInput(Left, 0);
+      SendInput(Left, 0);
       break;
     case Qt::Key_Right:
-      controller_->userInput(Right, 0);
+      SendInput(Right, 0);
       break;
     case Qt::Key_Up:
-      controller_->userInput(Up, 0);
+      SendInput(Up, 0);
       break;
     case Qt::Key_Down:
-      controller_->userInput(Down, 0);
+      SendInput(Down, 0);
       break;
     case Qt::Key_R:
-      controller_->userInput(Action, true);
+      SendInput(Action, true);
       break;
     case Qt::Key_Return:
-      controller_->userInput(Start, 0);
+      SendInput(Start, 0);
+      break;
+    case Qt::Key_L:
+      latency_.overlay = !latency_.overlay;
+      update(latencyRect_.adjusted(0, 0, 1, 1));
       break;
     default:
       QWidget::keyPressEvent(event);
@@ -81,6 +128,22 @@ void SnakeQT::keyPressEvent(QKeyEvent *event) {
   }
 }
 
+/**
+ * @brief Передает действие игре.
+ *
+ * Поток игры получает его через очередь без блокировок. Без потока шаг
+ * игры выполняется сразу, а таймер перезапускается: ввод может запустить
+ * или остановить игру. Время нажатия отмечается для гистограммы ввода.
+ *
+ * @param action Действие пользователя.
+ * @param hold Удержание клавиши.
+ */
+void SnakeQT::SendInput(UserAction_t action, bool hold) {
+  ::latencyKeyPressed(&latency_, ::tickNow());
+  controller_->Post(action, hold);
+  if (!controller_->Threaded()) UpdateGame();
+}
+
 void SnakeQT::closeEvent(QCloseEvent *event) {
   emit gameClosed();
   QWidget::closeEvent(event);
@@ -88,77 +151,249 @@ void SnakeQT::closeEvent(QCloseEvent *event) {
 /**
  * @brief Обработка события показа окна.
  *
- * Эта функция вызывается при показе окна и может использоваться для
- * выполнения дополнительных действий, таких как сброс состояния игры.
+ * Показ из меню начинает новую игру. Восстановление свернутого окна
+ * (событие от оконной системы) продолжает игру, приостановленную при
+ * скрытии.
  *
  * @param event Указатель на событие показа.
  */
 void SnakeQT::showEvent(QShowEvent *event) {
   QWidget::showEvent(event);
-  ResetGame();
+  if (event->spontaneous() && suspended_) {
+    ResumeGame();
+  } else {
+    ResetGame();
+  }
+}
+
+/**
+ * @brief Обработка события скрытия окна: приостанавливает игру.
+ *
+ * @param event Указатель на событие скрытия.
+ */
+void SnakeQT::hideEvent(QHideEvent *event) {
+  SuspendGame();
+  QWidget::hideEvent(event);
+}
+
+/**
+ * @brief Останавливает поток игры и таймер и ставит идущую игру на паузу.
+ *
+ * Пауза передается контроллеру, как нажатие P, и попадает в запись
+ * партии. Пока окно скрыто, змейка не двигается и не будит ни поток игры,
+ * ни поток GUI.
+ */
+void SnakeQT::SuspendGame() {
+  StopSimulation();
+  suspended_ = true;
+  pausedOnHide_ =
+      flagError_ != true && controller_->game->gameInfo.pause == STARTED;
+  if (pausedOnHide_) {
+    controller_->Post(Pause, 0);
+    controller_->Run();
+  }
+}
+
+/**
+ * @brief Продолжает игру, приостановленную SuspendGame.
+ *
+ * Снимает паузу, только если ее поставило скрытие окна, и снова запускает
+ * поток игры (или таймер, если поток запустить не удалось).
+ */
+void SnakeQT::ResumeGame() {
+  suspended_ = false;
+  if (flagError_ == true) return;
+  if (pausedOnHide_) controller_->Post(Pause, 0);
+  pausedOnHide_ = false;
+  if (!controller_->StartThread()) UpdateGame();
 }
 /**
  * @brief Сброс состояния игры.
  *
- * Эта функция сбрасывает игру и контроллер в начальное состояние.
+ * Эта функция сбрасывает игру и контроллер в начальное состояние и
+ * запускает поток игры.
  */
 void SnakeQT::ResetGame() {
-  if (controller_ != nullptr) delete controller_;
+  DestroyGame();
+  suspended_ = false;
+  pausedOnHide_ = false;
 
   controller_ = new Controller(new s21::Snake());
+  controller_->SetLatency(&latency_);
+  controller_->StartRecording();
+  controller_->OnFrame([this] {
+    QMetaObject::invokeMethod(
+        this, [this] { PresentFrame(); }, Qt::QueuedConnection);
+  });
+  shown_ = &controller_->Snapshot();
+  shownSequence_ = 0;
+  update();
 
   flagError_ = controller_->game->GetFlagErrorGame();
-  if (flagError_ != true) {
-    if (timer_) {
-      timer_->stop();
-      timer_->start(100);
-    }
-  }
+  if (flagError_ != true) controller_->StartThread();
 }
 
 /**
- * @brief Функция обновления игры
+ * @brief Функция обновления игры без потока игры
  *
+ * Выполняет шаг игры в потоке GUI и взводит таймер на следующий шаг.
  */
-void SnakeQT::UpdateGame() {
-  if (controller_->game->gameInfo.pause != QUIT) {
-    if (controller_->game->gameInfo.pause == STARTED) {
-      controller_->updateCurrentState();
-    }
-    update();
+void SnakeQT::UpdateGame() { ScheduleTick(controller_->Run()); }
+
+/**
+ * @brief Взводит таймер на момент следующего шага змейки.
+ *
+ * Пока игра не идет или окно скрыто, таймер остановлен и поток GUI не
+ * просыпается.
+ *
+ * @param waitNs Наносекунды до следующего шага (отрицательное значение -
+ * игра не идет).
+ */
+void SnakeQT::ScheduleTick(int64_t waitNs) {
+  if (!timer_) return;
+  if (waitNs >= 0 && isVisible()) {
+    timer_->start(
+        static_cast<int>((waitNs + TICK_NS_PER_MS - 1) / TICK_NS_PER_MS));
   } else {
     timer_->stop();
+  }
+}
+
+/**
+ * @brief Забирает последний снимок и перерисовывает изменившиеся части
+ * окна.
+ *
+ * Вызывается в потоке GUI по уведомлению контроллера. Перерисовываются
+ * только области, изменившиеся после показанного снимка. При выходе из
+ * игры поток останавливается, запись партии сохраняется и окно
+ * закрывается.
+ */
+void SnakeQT::PresentFrame() {
+  shown_ = &controller_->Snapshot();
+  if (shown_->info.pause == QUIT) {
+    StopSimulation();
+    controller_->SaveReplay(REPLAY_DIR);
     close();
-    return;
+  } else if (shown_->sequence != shownSequence_) {
+    UpdateChanged(shown_->ChangesSince(shownSequence_));
+    shownSequence_ = shown_->sequence;
+  }
+}
+
+/**
+ * @brief Останавливает поток игры и таймер.
+ */
+void SnakeQT::StopSimulation() {
+  controller_->StopThread();
+  if (timer_) timer_->stop();
+}
+
+/**
+ * @brief Запрашивает перерисовку только изменившихся областей окна.
+ *
+ * Смена статуса игры меняет надписи поверх поля, поэтому перерисовывается
+ * все окно. Включенный оверлей задержек обновляется с каждым снимком.
+ *
+ * @param diff Изменения после показанного снимка (ChangesSince).
+ */
+void SnakeQT::UpdateChanged(const FrameDiff_t &diff) {
+  if (latency_.overlay) update(latencyRect_.adjusted(0, 0, 1, 1));
+  if (diff.hud & FRAME_STATE) {
+    update();
+  } else {
+    for (uint32_t rows = diff.rows; rows; rows &= rows - 1) {
+      int row = __builtin_ctz(rows);
+      update(20, row * 20 + 20, WIDTH * 20 + 1, 21);
+    }
+    const int values[3] = {FRAME_HIGH_SCORE, FRAME_SCORE, FRAME_LEVEL};
+    for (int i = 0; i < 3; i++) {
+      if (diff.hud & values[i]) update(valueRects_[i].adjusted(0, 0, 1, 1));
+    }
   }
 }
 
 /**
  * @brief Обработка события рисования.
  *
- * Эта функция вызывается, когда необходимо перерисовать окно.
+ * Статичный фон берется из кэша, поверх него рисуются яблоко, змейка,
+ * значения панели и надписи. Qt ограничивает рисование областью события,
+ * поэтому стоимость кадра зависит от размера изменившихся областей.
+ * Длительность рисования записывается в гистограмму отрисовки.
  *
  * @param event Указатель на событие рисования.
  */
 void SnakeQT::paintEvent(QPaintEvent *event) {
+  TRACE_SPAN("SnakeQT::paintEvent");
+  int64_t start = ::tickNow();
+  if (background_.isNull() ||
+      background_.devicePixelRatio() != devicePixelRatioF()) {
+    RebuildBackground();
+  }
   QPainter painter(this);
-  painter.fillRect(rect(), Qt::black);
+  painter.drawPixmap(0, 0, background_);
   QWidget::paintEvent(event);
-  DrawGame(painter);
+  DrawGame(painter, event->rect());
+  DrawValues(painter, event->rect());
 
   DrawAdditionalText(painter);
+  if (latency_.overlay) DrawLatencyOverlay(painter, latencyRect_, latency_);
+  painter.end();
+  ::latencyRecord(&latency_.paint, ::tickNow() - start);
+}
+
+/**
+ * @brief Сбрасывает кэш фона при изменении размера окна.
+ *
+ * @param event Указатель на событие изменения размера.
+ */
+void SnakeQT::resizeEvent(QResizeEvent *event) {
+  background_ = QPixmap();
+  QWidget::resizeEvent(event);
+}
+
+/**
+ * @brief Рисует в кэш статичный фон: сетку, клетки поля, рамки и подписи
+ * панели.
+ *
+ * Кэш строится в разрешении экрана и перестраивается только при изменении
+ * размера окна или плотности пикселей.
+ */
+void SnakeQT::RebuildBackground() {
+  qreal ratio = devicePixelRatioF();
+  background_ = QPixmap(size() * ratio);
+  background_.setDevicePixelRatio(ratio);
+  background_.fill(Qt::black);
+  QPainter painter(&background_);
+  painter.setFont(font());
+  InitialGameBar(painter);
+  DrawField(painter);
 }
 
 /**
  * @brief Основная функция отрисовки игры
  *
  * @param painter ссылка на объект отрисовщика QPainter
+ * @param dirty Перерисовываемая область окна
  */
-void SnakeQT::DrawGame(QPainter &painter) {
-  InitialGameBar(painter);
+void SnakeQT::DrawGame(QPainter &painter, const QRect &dirty) {
+  painter.setPen(QPen(Qt::white, 1, Qt::SolidLine, Qt::RoundCap,
+                      Qt::RoundJoin));
+  DrawApple(painter, dirty);
+  DrawSnake(painter, dirty);
+}
+
+/**
+ * @brief Отрисовка клеток игрового поля
+ *
+ * Клетки поля не меняются во время игры, поэтому рисуются в кэш фона.
+ *
+ * @param painter ссылка на объект отрисовщика QPainter
+ */
+void SnakeQT::DrawField(QPainter &painter) {
+  const SnakeSnapshot &state = *shown_;
   for (int i = 0; i < HEIGHT; i++) {
     for (int j = 0; j < WIDTH; j++) {
-      int colorIndex = controller_->game->gameInfo.field[i][j];
+      int colorIndex = state.info.field[i][j];
       if (colorIndex != 0) {
         QColor pieceColor = GetColorByIndex(colorIndex);
         painter.setBrush(pieceColor);
@@ -166,8 +401,6 @@ void SnakeQT::DrawGame(QPainter &painter) {
       }
     }
   }
-  DrawApple(painter);
-  DrawSnake(painter);
 }
 
 /**
@@ -257,30 +490,33 @@ void SnakeQT::InitialGameBar(QPainter &painter) {
  * @param painter ссылка на объект отрисовщика QPainter
  */
 void SnakeQT::DrawAdditionalText(QPainter &painter) {
-  QFont font = painter.font();
-  font.setPointSizeF(font.pointSizeF() * 1.5);
-  painter.setFont(font);
+  const SnakeSnapshot &state = *shown_;
+  painter.setFont(overlayFont_);
   QPen pen(Qt::white, 6);
   painter.setPen(pen);
-  if (controller_->game->gameInfo.pause == NOT_STARTED) {
+  if (state.info.pause == NOT_STARTED) {
     painter.drawText(25, 135, "Press Enter");
     painter.drawText(25, 175, "to Start Game");
 
-  } else if (controller_->game->gameInfo.pause == PAUSED) {
+  } else if (state.info.pause == PAUSED) {
     painter.drawText(30, 135, "GAME PAUSED");
     painter.drawText(30, 155, "Press P Key");
     painter.drawText(30, 175, "to Continue...");
 
-  } else if (controller_->game->gameInfo.pause == ENDED) {
+  } else if (state.info.pause == ENDED) {
     painter.drawText(55, 135, "GAME OVER");
-  } else if (controller_->game->gameInfo.pause == WIN) {
+  } else if (state.info.pause == WIN) {
     painter.drawText(25, 135, "Congratulations!");
     painter.drawText(25, 175, "YOU WIN!");
   }
 }
 
 /**
- * @brief Отрисовка игрового поля, дополнительных рамок и информации
+ * @brief Отрисовка рамок и подписей панели информации
+ *
+ * Значения рекорда, счета и уровня рисуются отдельно (DrawValues) в рамках,
+ * сохраненных в valueRects_. Под ними оставлено место для оверлея
+ * задержек (latencyRect_).
  *
  * @param painter ссылка на объект отрисовщика QPainter
  * @param gridSize int Размер левого игрового поля
@@ -294,22 +530,39 @@ void SnakeQT::DrawShapesForInfo(QPainter &painter, int &gridSize) {
   QRect rect1(xOffset, drawingSize.cellHeight, rectWidth * 2, rectHeight);
   painter.drawRect(rect1);
   DrawLabels(painter, rect1, "Snake");
-  std::vector<std::pair<QString, QString>> data = {
-      {"High\nScore", QString::number(controller_->game->gameInfo.high_score)},
-      {"Score", QString::number(controller_->game->gameInfo.score)},
-      {"Level", QString::number(controller_->game->gameInfo.level)}};
-  for (size_t i = 0; i < data.size(); i++) {
+  const QString labels[3] = {"High\nScore", "Score", "Level"};
+  for (int i = 0; i < 3; i++) {
     int yOffset =
         drawingSize.cellHeight + rectHeight * (i + 1) + spacing * (2 * i + 1);
     QRect rect1(xOffset, yOffset, rectWidth, rectHeight * 1.5);
     painter.fillRect(rect1, Qt::black);
     painter.drawRect(rect1);
-    DrawLabels(painter, rect1, data[i].first);
+    DrawLabels(painter, rect1, labels[i]);
 
     QRect rect2(xOffset + rectWidth + 10, yOffset, rectWidth, rectHeight * 1.5);
     painter.fillRect(rect2, Qt::black);
     painter.drawRect(rect2);
-    DrawLabels(painter, rect2, data[i].second);
+    valueRects_[i] = rect2;
+  }
+  latencyRect_ =
+      QRect(xOffset, valueRects_[2].bottom() + 5, rectWidth * 2 + 10, 36);
+}
+
+/**
+ * @brief Отрисовка значений рекорда, счета и уровня
+ *
+ * @param painter ссылка на объект отрисовщика QPainter
+ * @param dirty Перерисовываемая область окна
+ */
+void SnakeQT::DrawValues(QPainter &painter, const QRect &dirty) {
+  const SnakeSnapshot &state = *shown_;
+  const int values[3] = {state.info.high_score, state.info.score,
+                         state.info.level};
+  painter.setPen(Qt::white);
+  for (int i = 0; i < 3; i++) {
+    if (dirty.intersects(valueRects_[i])) {
+      DrawLabels(painter, valueRects_[i], QString::number(values[i]));
+    }
   }
 }
 
@@ -347,27 +600,33 @@ void SnakeQT::DrawLabels(QPainter &painter, const QRect &rect,
  * @brief Отрисовка яблока на игровом поле
  *
  * @param painter ссылка на объект отрисовщика QPainter
+ * @param dirty Перерисовываемая область окна
  */
-void SnakeQT::DrawApple(QPainter &painter) {
-  int appleX = controller_->game->gameInfo.next[0][0];
-  int appleY = controller_->game->gameInfo.next[0][1];
-  QColor pieceColor = GetColorByIndex(3);
-  painter.setBrush(pieceColor);
-  painter.drawRect((appleX * 20) + 20, (appleY * 20) + 20, 20, 20);
+void SnakeQT::DrawApple(QPainter &painter, const QRect &dirty) {
+  const SnakeSnapshot &state = *shown_;
+  QRect cell((state.apple[0] * 20) + 20, (state.apple[1] * 20) + 20, 20, 20);
+  if (dirty.intersects(cell.adjusted(0, 0, 1, 1))) {
+    painter.setBrush(GetColorByIndex(3));
+    painter.drawRect(cell);
+  }
 }
 
 /**
  * @brief Отрисовка змейки на игровом поле
  *
+ * Сегменты вне перерисовываемой области пропускаются.
+ *
  * @param painter ссылка на объект отрисовщика QPainter
+ * @param dirty Перерисовываемая область окна
  */
-void SnakeQT::DrawSnake(QPainter &painter) {
-  std::vector snake = controller_->game->snakeCoordinates;
-
-  for (size_t i = 1; i < snake.size(); ++i) {
-    QColor pieceColor = GetColorByIndex(1);
-    painter.setBrush(pieceColor);
-    painter.drawRect((snake[i].x * 20) + 20, (snake[i].y * 20) + 20, 20, 20);
+void SnakeQT::DrawSnake(QPainter &painter, const QRect &dirty) {
+  const SnakeSnapshot &state = *shown_;
+  const Snake::SnakeElement *snake = state.body;
+
+  painter.setBrush(GetColorByIndex(1));
+  for (size_t i = 1; i < state.length; ++i) {
+    QRect cell((snake[i].x * 20) + 20, (snake[i].y * 20) + 20, 20, 20);
+    if (dirty.intersects(cell.adjusted(0, 0, 1, 1))) painter.drawRect(cell);
   }
   QColor pieceColor = GetColorByIndex(2);
   painter.setBrush(pieceColor);
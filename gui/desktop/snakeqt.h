@@ -2,6 +2,7 @@
 #define CPP3_BRICKGAME_SRC_GUI_DESKTOP_SNAKEQT_H_
 
 #include <QFontDatabase>
+#include <QHideEvent>
 #include <QKeyEvent>
 #include <QPainter>
 #include <QShowEvent>
@@ -28,23 +29,37 @@ class SnakeQT : public QWidget {
  protected:
   void closeEvent(QCloseEvent *event) override;
   void showEvent(QShowEvent *event) override;
+  void hideEvent(QHideEvent *event) override;
   void keyPressEvent(QKeyEvent *event) override;
   void paintEvent(QPaintEvent *event) override;
+  void resizeEvent(QResizeEvent *event) override;
 
   void UpdateGame();
+  void ScheduleTick(int64_t waitNs);
+  void SendInput(UserAction_t action, bool hold);
+  void PresentFrame();
+  void StopSimulation();
+  void SuspendGame();
+  void ResumeGame();
+  void UpdateChanged(const FrameDiff_t &diff);
+  void RebuildBackground();
 
-  void DrawGame(QPainter &painter);
+  void DrawGame(QPainter &painter, const QRect &dirty);
+  void DrawValues(QPainter &painter, const QRect &dirty);
   int DrawGrid(QPainter &painter);
   void DrawAdditionalText(QPainter &painter);
   void DrawShapesForInfo(QPainter &painter, int &gridSize);
   void DrawLabels(QPainter &painter, const QRect &rect, const QString &text);
   void InitialDrawingSizes();
   void InitialGameBar(QPainter &pointer);
-  void DrawSnake(QPainter &pointer);
-  void DrawApple(QPainter &pointer);
+  void DrawField(QPainter &painter);
+  void DrawSnake(QPainter &pointer, const QRect &dirty);
+  void DrawApple(QPainter &pointer, const QRect &dirty);
   void ResetGame();
+  void DestroyGame();
 
   QColor GetColorByIndex(int colorIndex) const;
+  static const QString &GameFontFamily();
 
  signals:
   /**
@@ -54,9 +69,18 @@ class SnakeQT : public QWidget {
 
  private:
   DrawingSize drawingSize;  ///< Объект структуры DrawingSize
-  Controller *controller_;  ///< Ссылка на объект класса Controller
-  QTimer *timer_;  ///< Таймер для управления обновлением игры.
+  Controller *controller_;  ///< Контроллер текущей игры (nullptr - нет игры)
+  QTimer *timer_;  ///< Таймер следующего шага, если поток игры не запущен
   int flagError_;  ///< Флаг ошибки при работе программы
+  QPixmap background_;  ///< Рамки, сетка, клетки поля и подписи
+  QRect valueRects_[3];  ///< Рамки рекорда, счета и уровня
+  QRect latencyRect_;  ///< Рамка оверлея задержек
+  QFont overlayFont_;  ///< Шрифт надписей статуса игры
+  LatencyStats_t latency_;  ///< Гистограммы шагов, отрисовки и ввода
+  const SnakeSnapshot *shown_ = nullptr;  ///< Снимок, показанный в окне
+  uint64_t shownSequence_ = 0;  ///< Номер снимка, показанного в окне
+  bool suspended_ = false;  ///< Окно скрыто, игра приостановлена
+  bool pausedOnHide_ = false;  ///< Паузу поставило скрытие окна
 };
 }  // namespace s21
 #endif  // CPP3_BRICKGAME_SRC_GUI_DESKTOP_SNAKEQT_H_
@@ -4,62 +4,76 @@ namespace s21 {
  * @brief Конструктор класса TetrisQT.
  *
  * Инициализирует окно игры Tetris, устанавливает размеры окна,
- * инициализирует таймер
+ * инициализирует таймер. Сама игра создается при показе окна (ResetGame).
+ * Игра идет в отдельном потоке (TetrisSim); таймер нужен, только если
+ * поток запустить не удалось. Таймер однократный: он взводится на момент
+ * следующего такта и не работает, пока игра не идет или окно скрыто.
+ * Гистограммы задержек копятся, пока окно существует, и при закрытии
+ * приложения дописываются в LATENCY_FILE.
  *
  * @param parent Указатель на родительский виджет (по умолчанию nullptr).
  */
-TetrisQT::TetrisQT(QWidget *parent) : QWidget(parent), counter_(1) {
-  srand(time(NULL));
+TetrisQT::TetrisQT(QWidget *parent)
+    : QWidget(parent), flagError_(ERROR), timer_(nullptr), shown_(nullptr) {
   setFixedSize(405, 440);
-  flagError_ = ::initialGame(&game_);
-  ::userInput(&game_, Start, 0);
-  if (flagError_ != ERROR) {
-    timer_ = new QTimer(this);
-    connect(timer_, &QTimer::timeout, this, &TetrisQT::GameLoop);
-    timer_->start(READ_DELAY);
-  }
+  overlayFont_ = font();
+  overlayFont_.setPointSizeF(overlayFont_.pointSizeF() * 1.5);
+  ::latencyStatsInit(&latency_);
+  timer_ = new QTimer(this);
+  timer_->setSingleShot(true);
+  timer_->setTimerType(Qt::PreciseTimer);
+  connect(timer_, &QTimer::timeout, this, &TetrisQT::GameLoop);
 }
 
 /**
  * @brief Деструктор класса TetrisQT.
  *
  * Освобождает память, используемую объектом TetrisQT,
- * и генерирует сигнал о закрытии игры.
+ * и генерирует сигнал о закрытии игры. Недоигранная партия сохраняется в
+ * архив записей, гистограммы задержек дописываются в LATENCY_FILE.
  */
 TetrisQT::~TetrisQT() {
   emit gameClosed();
+  StopSimulation();
+  ArchiveReplay();
+  ::latencyDump(&latency_, "tetris", LATENCY_FILE);
   ::freeSpace(&game_);
 }
 
 /**
  * @brief Обработка нажатий клавиш.
  *
- * Эта функция вызывается при нажатии клавиш на клавиатуре.
+ * Эта функция вызывается при нажатии клавиш на клавиатуре. Клавиша L
+ * включает и выключает оверлей задержек.
  *
  * @param event Указатель на событие нажатия клавиши.
  */
 void TetrisQT::keyPressEvent(QKeyEvent *event) {
   switch (event->key()) {
     case Qt::Key_Escape:
-      ::userInput(&game_, Terminate, 0);
+      SendInput(Terminate);
       break;
     case Qt::Key_P:
-      ::userInput(&game_, Pause, 0);
+      SendInput(Pause);
       break;
     case Qt::Key_Left:
-      ::userInput(&game_, Left, 0);
+      SendInput(Left);
       break;
     case Qt::Key_Right:
-      ::userInput(&game_, Right, 0);
+      SendInput(Right);
       break;
     case Qt::Key_R:
-      ::userInput(&game_, Action, 0);
+      SendInput(Action);
       break;
     case Qt::Key_Down:
-      ::userInput(&game_, Down, 0);
+      SendInput(Down);
       break;
     case Qt::Key_Return:
-      ::userInput(&game_, Start, 0);
+      SendInput(Start);
+      break;
+    case Qt::Key_L:
+      latency_.overlay = !latency_.overlay;
+      update(latencyRect_.adjusted(0, 0, 1, 1));
       break;
     default:
       QWidget::keyPressEvent(event);
@@ -68,25 +82,122 @@ void TetrisQT::keyPressEvent(QKeyEvent *event) {
 }
 
 /**
- * @brief Основной цикл игры
- *  С помощью counter с определенной скоростью
- *  вызывает Обновление состояние игры
+ * @brief Передает действие игре.
+ *
+ * Поток игры получает его через очередь без блокировок. Без потока шаг
+ * игры выполняется сразу, а таймер перезапускается: ввод может запустить
+ * или остановить игру. Время нажатия отмечается для гистограммы ввода.
+ *
+ * @param action Действие пользователя.
  */
-void TetrisQT::GameLoop() {
-  if (game_.gameInfo.pause != QUIT) {
-    if (game_.gameInfo.pause == STARTED) {
-      if (counter_ >= (1.55 - game_.speed * SPEED_RATE)) {
-        ::updateCurrentState(&game_);
-        counter_ = 0.0;
-      }
-      counter_ += READ_DELAY * 0.001;
-    }
-    update();
+void TetrisQT::SendInput(::UserAction_t action) {
+  if (flagError_ != ERROR) {
+    ::latencyKeyPressed(&latency_, ::tickNow());
+    ::tetrisSimInput(&sim_, action, 0);
+    if (!sim_.thread.started) GameLoop();
+  }
+}
+
+/**
+ * @brief Основной цикл игры без потока игры
+ *  Выполняет шаг игры (ввод и такты гравитации, накопленные планировщиком
+ *  тактов) в потоке GUI и взводит таймер на следующий такт
+ */
+void TetrisQT::GameLoop() { ScheduleTick(::tetrisSimRun(&sim_)); }
+
+/**
+ * @brief Взводит таймер на момент следующего такта гравитации.
+ *
+ * Пока игра не идет или окно скрыто, таймер остановлен и поток GUI не
+ * просыпается.
+ *
+ * @param waitNs Наносекунды до следующего такта (отрицательное значение -
+ * игра не идет).
+ */
+void TetrisQT::ScheduleTick(int64_t waitNs) {
+  if (waitNs >= 0 && isVisible()) {
+    timer_->start(
+        static_cast<int>((waitNs + TICK_NS_PER_MS - 1) / TICK_NS_PER_MS));
   } else {
     timer_->stop();
+  }
+}
+
+/**
+ * @brief Уведомление о новом кадре из потока игры.
+ *
+ * Только ставит вызов PresentFrame в очередь событий потока GUI.
+ *
+ * @param widget Указатель на TetrisQT.
+ */
+void TetrisQT::NotifyFrame(void *widget) {
+  TetrisQT *self = static_cast<TetrisQT *>(widget);
+  QMetaObject::invokeMethod(
+      self, [self] { self->PresentFrame(); }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Забирает последний кадр и перерисовывает изменившиеся части окна.
+ *
+ * Промежуточные кадры, опубликованные между вызовами, пропускаются: их
+ * изменения входят в изменения последнего кадра. При выходе из игры поток
+ * останавливается, запись партии сохраняется и окно закрывается.
+ */
+void TetrisQT::PresentFrame() {
+  shown_ = ::tetrisSimFrame(&sim_);
+  if (shown_->hud.state == QUIT) {
+    StopSimulation();
+    ArchiveReplay();
     close();
-    return;
+  } else if (shown_->sequence != shownSequence_) {
+    UpdateChanged(::tetrisFrameChanges(shown_, shownSequence_));
+    shownSequence_ = shown_->sequence;
+  }
+}
+
+/**
+ * @brief Останавливает поток игры и таймер.
+ */
+void TetrisQT::StopSimulation() {
+  ::tetrisSimStop(&sim_);
+  if (timer_) timer_->stop();
+}
+
+/**
+ * @brief Запрашивает перерисовку только изменившихся областей окна.
+ *
+ * Смена статуса игры меняет надписи поверх поля, поэтому перерисовывается
+ * все окно. Включенный оверлей задержек обновляется с каждым кадром.
+ *
+ * @param diff Изменения с предыдущего кадра (takeFrameDiff).
+ */
+void TetrisQT::UpdateChanged(const FrameDiff_t &diff) {
+  if (latency_.overlay) update(latencyRect_.adjusted(0, 0, 1, 1));
+  if (diff.hud & FRAME_STATE) {
+    update();
+  } else {
+    for (uint32_t rows = diff.rows; rows; rows &= rows - 1) {
+      int row = __builtin_ctz(rows);
+      update(20, row * 20 + 20, WIDTH * 20 + 1, 21);
+    }
+    if (diff.hud & FRAME_NEXT) update(320, 100, 81, 41);
+    const int values[3] = {FRAME_HIGH_SCORE, FRAME_SCORE, FRAME_LEVEL};
+    for (int i = 0; i < 3; i++) {
+      if (diff.hud & values[i]) update(valueRects_[i].adjusted(0, 0, 1, 1));
+    }
+  }
+}
+
+/**
+ * @brief Сохраняет запись текущей партии в архив и очищает ее.
+ *
+ * Пустая запись (партия без ввода) не сохраняется.
+ */
+void TetrisQT::ArchiveReplay() {
+  if (replay_.events) {
+    ::replayArchive(&replay_, REPLAY_DIR, game_.gameInfo.score);
   }
+  ::replayFree(&replay_);
 }
 
 /**
@@ -105,31 +216,85 @@ void TetrisQT::closeEvent(QCloseEvent *event) {
 /**
  * @brief Обработка события показа окна.
  *
- * Эта функция вызывается, когда окно становится видимым.
+ * Показ из меню начинает новую игру. Восстановление свернутого окна
+ * (событие от оконной системы) продолжает игру, приостановленную при
+ * скрытии.
  *
  * @param event Указатель на событие показа.
  */
 void TetrisQT::showEvent(QShowEvent *event) {
   QWidget::showEvent(event);
-  ResetGame();
+  if (event->spontaneous() && suspended_) {
+    ResumeGame();
+  } else {
+    ResetGame();
+  }
+}
+
+/**
+ * @brief Обработка события скрытия окна: приостанавливает игру.
+ *
+ * @param event Указатель на событие скрытия.
+ */
+void TetrisQT::hideEvent(QHideEvent *event) {
+  SuspendGame();
+  QWidget::hideEvent(event);
+}
+
+/**
+ * @brief Останавливает поток игры и таймер и ставит идущую игру на паузу.
+ *
+ * Пауза проходит через очередь ввода, как нажатие P, и попадает в запись
+ * партии. Пока окно скрыто, игра не выполняет такты и не будит ни поток
+ * игры, ни поток GUI.
+ */
+void TetrisQT::SuspendGame() {
+  StopSimulation();
+  suspended_ = true;
+  pausedOnHide_ = flagError_ != ERROR && game_.gameInfo.pause == STARTED;
+  if (pausedOnHide_) {
+    ::tetrisSimInput(&sim_, Pause, 0);
+    ::tetrisSimRun(&sim_);
+  }
+}
+
+/**
+ * @brief Продолжает игру, приостановленную SuspendGame.
+ *
+ * Снимает паузу, только если ее поставило скрытие окна, и снова запускает
+ * поток игры (или таймер, если поток запустить не удалось).
+ */
+void TetrisQT::ResumeGame() {
+  suspended_ = false;
+  if (flagError_ == ERROR) return;
+  if (pausedOnHide_) ::tetrisSimInput(&sim_, Pause, 0);
+  pausedOnHide_ = false;
+  if (!::tetrisSimStart(&sim_)) GameLoop();
 }
 
 /**
  * @brief Сброс игры.
  *
  * Эта функция сбрасывает параметры игры к начальным значениям
- * и перезапускает таймер.
+ * и запускает поток игры.
  */
 void TetrisQT::ResetGame() {
-  if (timer_->isActive()) {
-    timer_->stop();
-  }
+  StopSimulation();
+  suspended_ = false;
+  pausedOnHide_ = false;
 
+  ArchiveReplay();
   ::freeSpace(&game_);
   flagError_ = ::initialGame(&game_);
+  if (flagError_ != ERROR) ::attachHighScoreFile(&game_);
+  if (flagError_ != ERROR) ::recordReplay(&game_, &replay_);
 
-  counter_ = 0.0;
-  timer_->start(READ_DELAY);
+  ::tetrisSimInit(&sim_, &game_, &TetrisQT::NotifyFrame, this);
+  sim_.latency = &latency_;
+  if (flagError_ != ERROR) ::tetrisSimRun(&sim_);
+  shown_ = ::tetrisSimFrame(&sim_);
+  shownSequence_ = shown_->sequence;
+  if (flagError_ != ERROR) ::tetrisSimStart(&sim_);
 
   update();
 }
@@ -137,15 +302,23 @@ void TetrisQT::ResetGame() {
 /**
  * @brief Отрисовывает Фигуры на поле
  *
+ * Клетки берутся из показанного кадра, текущая фигура уже нарисована в
+ * них. Клетки вне перерисовываемой области пропускаются.
+ *
  * @param painter ссылка на объект отрисовщика QPainter
+ * @param dirty Перерисовываемая область окна
  */
-void TetrisQT::DrawGame(QPainter &painter) {
-  InitialGameBar(painter);
+void TetrisQT::DrawGame(QPainter &painter, const QRect &dirty) {
+  painter.setPen(QPen(Qt::white, 1, Qt::SolidLine, Qt::RoundCap,
+                      Qt::RoundJoin));
   DrawNext(painter);
 
   for (int i = 0; i < HEIGHT; i++) {
+    if (!dirty.intersects(QRect(20, i * 20 + 20, WIDTH * 20 + 1, 21))) {
+      continue;
+    }
     for (int j = 0; j < WIDTH; j++) {
-      int colorIndex = game_.gameInfo.field[i][j];
+      int colorIndex = shown_->cells[i][j];
       if (colorIndex != 0) {
         QColor pieceColor = GetColorByIndex(colorIndex);
         painter.setBrush(pieceColor);
@@ -153,29 +326,6 @@ void TetrisQT::DrawGame(QPainter &painter) {
       }
     }
   }
-
-  if (game_.gameInfo.pause != ENDED) {
-    DrawFigure(painter);
-  }
-}
-
-/**
- * @brief Отрисовывает текущую фигуру на игровом поле.
- *
- * @param painter ссылка на объект отрисовщика QPainter
- */
-void TetrisQT::DrawFigure(QPainter &painter) {
-  for (int y = 0; y < 4; y++) {
-    for (int x = 0; x < 4; x++) {
-      if (game_.figure.shape[y][x] && game_.figure.y + y >= 0) {
-        QColor pieceColor =
-            GetColorByIndex(game_.figure.indexTetramino % 7 + 1);
-        painter.setBrush(pieceColor);
-        painter.drawRect(((game_.figure.x + x) * 20) + 20,
-                         ((game_.figure.y + y) * 20) + 20, 20, 20);
-      }
-    }
-  }
 }
 
 /**
@@ -189,8 +339,8 @@ void TetrisQT::DrawNext(QPainter &painter) {
   int pieceStartY = 60;
   for (int i = 2; i < 4; i++) {
     for (int j = 0; j < 4; j++) {
-      if (game_.gameInfo.next[i][j]) {
-        QColor pieceColor = GetColorByIndex(game_.figure.indexNext % 7 + 1);
+      if (shown_->next[i][j]) {
+        QColor pieceColor = GetColorByIndex(shown_->next[i][j]);
         painter.setBrush(pieceColor);
         painter.drawRect((pieceStartX + j * 20), (pieceStartY + i * 20), 20,
                          20);
@@ -202,17 +352,56 @@ void TetrisQT::DrawNext(QPainter &painter) {
 /**
  * @brief Обработка события рисования.
  *
- * Эта функция вызывается, когда необходимо перерисовать окно.
+ * Статичный фон берется из кэша, поверх него рисуются клетки, значения
+ * панели и надписи. Qt ограничивает рисование областью события, поэтому
+ * стоимость кадра зависит от размера изменившихся областей. Длительность
+ * рисования записывается в гистограмму отрисовки.
  *
  * @param event Указатель на событие рисования.
  */
 void TetrisQT::paintEvent(QPaintEvent *event) {
+  TRACE_SPAN("TetrisQT::paintEvent");
+  int64_t start = ::tickNow();
+  if (background_.isNull() ||
+      background_.devicePixelRatio() != devicePixelRatioF()) {
+    RebuildBackground();
+  }
   QPainter painter(this);
-  painter.fillRect(rect(), Qt::black);
+  painter.drawPixmap(0, 0, background_);
   QWidget::paintEvent(event);
 
-  DrawGame(painter);
+  DrawGame(painter, event->rect());
+  DrawValues(painter, event->rect());
   DrawAdditionalText(painter);
+  if (latency_.overlay) DrawLatencyOverlay(painter, latencyRect_, latency_);
+  painter.end();
+  ::latencyRecord(&latency_.paint, ::tickNow() - start);
+}
+
+/**
+ * @brief Сбрасывает кэш фона при изменении размера окна.
+ *
+ * @param event Указатель на событие изменения размера.
+ */
+void TetrisQT::resizeEvent(QResizeEvent *event) {
+  background_ = QPixmap();
+  QWidget::resizeEvent(event);
+}
+
+/**
+ * @brief Рисует в кэш статичный фон: сетку поля, рамки и подписи панели.
+ *
+ * Кэш строится в разрешении экрана и перестраивается только при изменении
+ * размера окна или плотности пикселей.
+ */
+void TetrisQT::RebuildBackground() {
+  qreal ratio = devicePixelRatioF();
+  background_ = QPixmap(size() * ratio);
+  background_.setDevicePixelRatio(ratio);
+  background_.fill(Qt::black);
+  QPainter painter(&background_);
+  painter.setFont(font());
+  InitialGameBar(painter);
 }
 
 /**
@@ -222,21 +411,19 @@ void TetrisQT::paintEvent(QPaintEvent *event) {
  * @param painter ссылка на объект отрисовщика QPainter
  */
 void TetrisQT::DrawAdditionalText(QPainter &painter) {
-  QFont font = painter.font();                  // Get the current font
-  font.setPointSizeF(font.pointSizeF() * 1.5);  // Double the current size
-  painter.setFont(font);
+  painter.setFont(overlayFont_);
   QPen pen(Qt::white, 6);
   painter.setPen(pen);
-  if (game_.gameInfo.pause == NOT_STARTED) {
+  if (shown_->hud.state == NOT_STARTED) {
     painter.drawText(40, 135, "Press Enter");
     painter.drawText(80, 175, "to Start Game");
 
-  } else if (game_.gameInfo.pause == PAUSED) {
+  } else if (shown_->hud.state == PAUSED) {
     painter.drawText(40, 135, "GAME PAUSED");
     painter.drawText(70, 155, "Press P Key");
     painter.drawText(100, 175, "to Continue...");
 
-  } else if (game_.gameInfo.pause == ENDED) {
+  } else if (shown_->hud.state == ENDED) {
     painter.drawText(60, 135, "GAME OVER");
   }
 }
@@ -323,7 +510,11 @@ void TetrisQT::InitialGameBar(QPainter &painter) {
 }
 
 /**
- * @brief Отрисовка игрового поля, дополнительных рамок и информации
+ * @brief Отрисовка рамок и подписей панели информации
+ *
+ * Значения рекорда, счета и уровня рисуются отдельно (DrawValues) в рамках,
+ * сохраненных в valueRects_. Под ними оставлено место для оверлея
+ * задержек (latencyRect_).
  *
  * @param painter ссылка на объект отрисовщика QPainter
  * @param gridSize int Размер левого игрового поля
@@ -342,22 +533,38 @@ void TetrisQT::DrawShapesForInfo(QPainter &painter, int &gridSize) {
   painter.drawRect(rect2);
   DrawLabels(painter, rect2, "Next");
 
-  std::vector<std::pair<QString, QString>> data = {
-      {"High\nScore", QString::number(game_.gameInfo.high_score)},
-      {"Score", QString::number(game_.gameInfo.score)},
-      {"Level", QString::number(game_.gameInfo.level)}};
+  const QString labels[3] = {"High\nScore", "Score", "Level"};
   for (int i = 0; i < 3; i++) {
     int yOffset = drawingSize_.cellHeight + rectHeight * ((i + 1) * 1.5 + 1) +
                   spacing * (3 + i);
     QRect rect1(xOffset, yOffset, rectWidth, rectHeight * 1.5);
     painter.fillRect(rect1, Qt::black);
     painter.drawRect(rect1);
-    DrawLabels(painter, rect1, data[i].first);
+    DrawLabels(painter, rect1, labels[i]);
 
     QRect rect2(xOffset + rectWidth + 10, yOffset, rectWidth, rectHeight * 1.5);
     painter.fillRect(rect2, Qt::black);
     painter.drawRect(rect2);
-    DrawLabels(painter, rect2, data[i].second);
+    valueRects_[i] = rect2;
+  }
+  latencyRect_ =
+      QRect(xOffset, valueRects_[2].bottom() + 5, rectWidth * 2 + 10, 36);
+}
+
+/**
+ * @brief Отрисовка значений рекорда, счета и уровня
+ *
+ * @param painter ссылка на объект отрисовщика QPainter
+ * @param dirty Перерисовываемая область окна
+ */
+void TetrisQT::DrawValues(QPainter &painter, const QRect &dirty) {
+  const int values[3] = {shown_->hud.high_score, shown_->hud.score,
+                         shown_->hud.level};
+  painter.setPen(Qt::white);
+  for (int i = 0; i < 3; i++) {
+    if (dirty.intersects(valueRects_[i])) {
+      DrawLabels(painter, valueRects_[i], QString::number(values[i]));
+    }
   }
 }
 
@@ -390,4 +597,35 @@ void TetrisQT::DrawLabels(QPainter &painter, const QRect &rect,
     lineY += metrics.height();
   }
 }
+
+/**
+ * @brief Отрисовка оверлея задержек
+ *
+ * Три строки моноширинным шрифтом: такт (T), отрисовка (P) и ввод (I), в
+ * каждой p50/p99/max (latencySummary). Фон рамки непрозрачный, поэтому
+ * оверлей можно рисовать поверх панели.
+ *
+ * @param painter ссылка на объект отрисовщика QPainter
+ * @param rect Рамка оверлея
+ * @param latency Гистограммы задержек
+ */
+void DrawLatencyOverlay(QPainter &painter, const QRect &rect,
+                        const LatencyStats_t &latency) {
+  const LatencyHistogram_t *histograms[3] = {&latency.tick, &latency.paint,
+                                             &latency.input};
+  const char labels[3] = {'T', 'P', 'I'};
+  QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+  font.setPointSizeF(7);
+  painter.setFont(font);
+  painter.setPen(Qt::white);
+  painter.setBrush(Qt::black);
+  painter.drawRect(rect);
+  QRect line(rect.left() + 4, rect.top(), rect.width() - 8, rect.height() / 3);
+  for (int i = 0; i < 3; i++) {
+    char text[17];
+    ::latencySummary(histograms[i], labels[i], text, sizeof(text));
+    painter.drawText(line.translated(0, i * line.height()),
+                     Qt::AlignLeft | Qt::AlignVCenter, QString(text));
+  }
+}
 }  // namespace s21
@@ -1,13 +1,15 @@
 #ifndef CPP3_BRICKGAME_SRC_GUI_DESKTOP_TETRISQT_H_
 #define CPP3_BRICKGAME_SRC_GUI_DESKTOP_TETRISQT_H_
 
-#define SPEED_RATE 0.125
-#define READ_DELAY 50
-
+#include <QFontDatabase>
 #include <QFontMetrics>
 #include <QKeyEvent>
+#include <QPaintEvent>
+#include <QHideEvent>
 #include <QPainter>
+#include <QPixmap>
 #include <QRect>
+#include <QResizeEvent>
 #include <QShowEvent>
 #include <QTimer>
 #include <QWidget>
@@ -15,7 +17,8 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-#include "../../brick_game/tetris/tetris_backend.h"
+#include "../../brick_game/tetris/tetris_score.h"
+#include "../../brick_game/tetris/tetris_sim.h"
 #ifdef __cplusplus
 }
 #endif
@@ -33,6 +36,9 @@ typedef struct {
   int xOffset;
 } DrawingSize;
 
+void DrawLatencyOverlay(QPainter &painter, const QRect &rect,
+                        const LatencyStats_t &latency);
+
 /**
  * @brief Класс, отвечающий за отрисовку Tetris в QT
  * @ingroup TetrisGame
@@ -53,13 +59,17 @@ class TetrisQT : public QWidget {
  protected:
   void closeEvent(QCloseEvent *event) override;
   void showEvent(QShowEvent *event) override;
+  void hideEvent(QHideEvent *event) override;
   void keyPressEvent(QKeyEvent *event) override;
   void paintEvent(QPaintEvent *event) override;
+  void resizeEvent(QResizeEvent *event) override;
   void ResetGame();
 
-  void DrawGame(QPainter &painter);
-  void DrawFigure(QPainter &painter);
+  void RebuildBackground();
+  void UpdateChanged(const FrameDiff_t &diff);
+  void DrawGame(QPainter &painter, const QRect &dirty);
   void DrawNext(QPainter &painter);
+  void DrawValues(QPainter &painter, const QRect &dirty);
   void DrawAdditionalText(QPainter &painter);
   int DrawGrid(QPainter &painter);
 
@@ -69,14 +79,32 @@ class TetrisQT : public QWidget {
   void DrawLabels(QPainter &painter, const QRect &rect, const QString &text);
   QColor GetColorByIndex(int colorIndex) const;
   void GameLoop();
+  void ScheduleTick(int64_t waitNs);
+  void SendInput(::UserAction_t action);
+  void PresentFrame();
+  void StopSimulation();
+  void SuspendGame();
+  void ResumeGame();
+  void ArchiveReplay();
+  static void NotifyFrame(void *widget);
 
  private:
   DrawingSize drawingSize_;  ///< Объект структуры DrawingSize
 
-  Tetris game_;  ///< Объект игры Tetris
+  Tetris game_{};  ///< Объект игры Tetris (создается в ResetGame)
+  Replay_t replay_{};  ///< Запись текущей партии
   int flagError_;  ///< Флаг ошибки при работе программы
-  QTimer *timer_;  ///< Таймер для управления обновлением игры.
-  double counter_;  ///< Счетчик для обработки скорости игры
+  QTimer *timer_;  ///< Таймер следующего такта, если поток игры не запущен
+  TetrisSim_t sim_{};  ///< Поток игры, очередь ввода и кадры
+  const TetrisFrame_t *shown_;  ///< Кадр, показанный в окне
+  uint64_t shownSequence_ = 0;  ///< Номер показанного кадра
+  bool suspended_ = false;  ///< Окно скрыто, игра приостановлена
+  bool pausedOnHide_ = false;  ///< Паузу поставило скрытие окна
+  QPixmap background_;  ///< Рамки, сетка и подписи (без значений)
+  QRect valueRects_[3];  ///< Рамки рекорда, счета и уровня
+  QRect latencyRect_;  ///< Рамка оверлея задержек
+  QFont overlayFont_;  ///< Шрифт надписей статуса игры
+  LatencyStats_t latency_;  ///< Гистограммы тактов, отрисовки и ввода
 };
 }  // namespace s21
 
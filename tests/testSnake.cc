@@ -1,8 +1,10 @@
 
 
 #include <gtest/gtest.h>
+#include <atomic>
 #include <cstdlib>
 #include <ctime>
+#include <string>
 
 #include "../brick_game/snake/controller/controller.h"
 #include "../brick_game/snake/model/snake.h"
@@ -66,8 +68,10 @@ TEST_F(SnakeGameTest, loseGame1) {
   Controller controller (&game);
   game.GameStart();
 Snake::SnakeElement newElement = {0, 0};
-   auto iter = game.snakeCoordinates.cbegin();
-  game.snakeCoordinates.insert(iter, newElement);
+   std::vector<Snake::SnakeElement> snake(game.snakeCoordinates.begin(),
+                                         game.snakeCoordinates.end());
+  snake.insert(snake.begin(), newElement);
+  game.SetSnake(snake);
   controller.userInput(Up, 0);
   game.MovingSnake();
   EXPECT_TRUE(game.gameInfo.pause == LOSED);
@@ -78,8 +82,10 @@ TEST_F(SnakeGameTest, loseGame2) {
   game.GameStart();
 Snake::SnakeElement newElement = {0, 0};
 
-   auto iter = game.snakeCoordinates.cbegin();
-  game.snakeCoordinates.insert(iter, newElement);
+   std::vector<Snake::SnakeElement> snake(game.snakeCoordinates.begin(),
+                                         game.snakeCoordinates.end());
+  snake.insert(snake.begin(), newElement);
+  game.SetSnake(snake);
   controller.userInput(Left, 0);
   game.MovingSnake();
   EXPECT_TRUE(game.gameInfo.pause == LOSED);
@@ -89,10 +95,12 @@ TEST_F(SnakeGameTest, loseGame3) {
   Controller controller (&game);
   game.GameStart();
 
-   auto iter = game.snakeCoordinates.cbegin();
+   std::vector<Snake::SnakeElement> snake(game.snakeCoordinates.begin(),
+                                         game.snakeCoordinates.end());
 Snake::SnakeElement newElement = {WIDTH - 1, HEIGHT - 1};
 
-  game.snakeCoordinates.insert(iter, newElement);
+  snake.insert(snake.begin(), newElement);
+  game.SetSnake(snake);
     controller.userInput(Right, 0);
   game.MovingSnake();
   EXPECT_TRUE(game.gameInfo.pause == LOSED);
@@ -104,8 +112,10 @@ TEST_F(SnakeGameTest, loseGame4) {
   game.GameStart();
 Snake::SnakeElement newElement = {WIDTH - 1, HEIGHT - 1};
 
-   auto iter = game.snakeCoordinates.cbegin();
-  game.snakeCoordinates.insert(iter,newElement);
+   std::vector<Snake::SnakeElement> snake(game.snakeCoordinates.begin(),
+                                         game.snakeCoordinates.end());
+  snake.insert(snake.begin(), newElement);
+  game.SetSnake(snake);
     controller.userInput(Down, 0);
 
   game.MovingSnake();
@@ -116,7 +126,7 @@ TEST_F(SnakeGameTest, loseGame5) {
   Controller controller (&game);
   game.GameStart();
 
-  game.snakeCoordinates = { {1, 1}, {2, 1}, {2, 0}, {1, 0}, {0,0} };
+  game.SetSnake({ {1, 1}, {2, 1}, {2, 0}, {1, 0}, {0,0} });
   controller.userInput(Up, 0);
   game.MovingSnake();
   game.MovingSnake();
@@ -124,6 +134,275 @@ TEST_F(SnakeGameTest, loseGame5) {
 
 }
 
+TEST_F(SnakeGameTest, RingBufferWraps) {
+  RingBuffer<int> ring(3);
+  EXPECT_TRUE(ring.empty());
+  for (int i = 1; i <= 5; i++) {
+    ring.push_front(i);
+    if (ring.size() == 3) ring.pop_back();
+  }
+  EXPECT_EQ(ring.size(), 2u);
+  EXPECT_EQ(ring.front(), 5);
+  EXPECT_EQ(ring[1], 4);
+  EXPECT_EQ(ring.back(), 4);
+  ring.push_front(6);
+  ring.push_front(7);
+  EXPECT_EQ(ring.size(), 3u);
+  EXPECT_EQ(ring.back(), 5);
+  std::vector<int> items(ring.begin(), ring.end());
+  EXPECT_EQ(items, (std::vector<int>{7, 6, 5}));
+  ring.assign(items.rbegin(), items.rend());
+  EXPECT_EQ(ring.front(), 5);
+  EXPECT_EQ(ring.capacity(), 3u);
+}
+
+TEST_F(SnakeGameTest, AppleOnLastFreeCell) {
+  Snake game(3);
+  std::vector<Snake::SnakeElement> body;
+  for (int y = 0; y < HEIGHT; y++) {
+    for (int x = 0; x < WIDTH; x++) {
+      if (x != 4 || y != 7) body.push_back({x, y});
+    }
+  }
+  game.SetSnake(body);
+  for (int i = 0; i < 10; i++) {
+    game.GenerateApple();
+    EXPECT_EQ(game.gameInfo.next[0][0], 4);
+    EXPECT_EQ(game.gameInfo.next[0][1], 7);
+  }
+  game.SetSnake({{0, 0}, {1, 0}});
+  for (int i = 0; i < 100; i++) {
+    game.GenerateApple();
+    EXPECT_FALSE(game.IsSnakeBody(game.gameInfo.next[0][0],
+                                  game.gameInfo.next[0][1]));
+  }
+}
+
+TEST_F(SnakeGameTest, OccupancyTracksBody) {
+  Snake game(11);
+  Controller controller(&game);
+  game.GameStart();
+  const UserAction_t turns[] = {Left, Up, Right, Down};
+  for (int tick = 0; tick < 60 && game.gameInfo.pause == STARTED; tick++) {
+    if (tick % 3 == 0) controller.userInput(turns[tick / 3 % 4], false);
+    game.gameInfo.next[0][0] = game.snakeCoordinates.front().x;
+    game.gameInfo.next[0][1] = game.snakeCoordinates.front().y - 1;
+    controller.Step();
+    for (int y = 0; y < HEIGHT; y++) {
+      for (int x = 0; x < WIDTH; x++) {
+        bool body = false;
+        for (const auto &segment : game.snakeCoordinates) {
+          body = body || (segment.x == x && segment.y == y);
+        }
+        ASSERT_EQ(game.IsSnakeBody(x, y), body);
+      }
+    }
+  }
+  EXPECT_GT(game.snakeCoordinates.size(), 4u);
+}
+
+TEST_F(SnakeGameTest, SnapshotIsSelfContained) {
+  Snake game(5);
+  Controller controller(&game);
+  controller.userInput(Start, false);
+  const SnakeSnapshot &first = controller.Snapshot();
+  EXPECT_EQ(first.info.pause, STARTED);
+  EXPECT_EQ(first.length, game.snakeCoordinates.size());
+  EXPECT_EQ(first.info.field[0], first.cells[0]);
+  EXPECT_EQ(first.info.next[0][0], game.gameInfo.next[0][0]);
+  uint64_t sequence = first.sequence;
+  int headY = first.body[0].y;
+
+  controller.Step();
+  GameInfo_t info = controller.updateCurrentState();
+  const SnakeSnapshot &second = controller.Snapshot();
+  EXPECT_NE(&first, &second);
+  EXPECT_EQ(second.sequence, sequence + 1);
+  EXPECT_EQ(info.field, second.info.field);
+  EXPECT_EQ(second.body[0].y, headY - 1);
+  EXPECT_EQ(first.body[0].y, headY);
+  EXPECT_EQ(first.sequence, sequence);
+
+  game.gameInfo.score = 42;
+  EXPECT_EQ(second.info.score, 0);
+  controller.userInput(Pause, false);
+  EXPECT_EQ(controller.Snapshot().info.score, 42);
+  EXPECT_EQ(controller.Snapshot().info.pause, PAUSED);
+}
+
+TEST_F(SnakeGameTest, SnapshotChangesSince) {
+  Snake game(5);
+  Controller controller(&game);
+  EXPECT_EQ(controller.Snapshot().ChangesSince(0).rows, FRAME_ROWS(HEIGHT));
+  controller.userInput(Start, false);
+  uint64_t shown = controller.Snapshot().sequence;
+  int headY = game.snakeCoordinates.front().y;
+  int tailY = game.snakeCoordinates.back().y;
+  EXPECT_EQ(controller.Snapshot().ChangesSince(shown).rows, 0u);
+
+  controller.Step();
+  controller.updateCurrentState();
+  controller.updateCurrentState();
+  FrameDiff_t diff = controller.Snapshot().ChangesSince(shown);
+  EXPECT_EQ(diff.rows, 1u << (headY - 1) | 1u << headY | 1u << tailY);
+  EXPECT_EQ(diff.hud, 0);
+
+  controller.userInput(Pause, false);
+  diff = controller.Snapshot().ChangesSince(shown);
+  EXPECT_EQ(diff.hud, FRAME_STATE);
+}
+
+TEST_F(SnakeGameTest, ResumeSkipsPausedTime) {
+  Snake game(8);
+  Controller controller(&game);
+  controller.userInput(Start, false);
+  game.gameInfo.speed = 5;
+  controller.updateCurrentState();
+  controller.userInput(Pause, false);
+  int headX = game.snakeCoordinates.front().x;
+  int headY = game.snakeCoordinates.front().y;
+  struct timespec pause = {0, 40000000};
+  nanosleep(&pause, nullptr);
+  controller.userInput(Pause, false);
+  controller.updateCurrentState();
+  EXPECT_EQ(game.snakeCoordinates.front().x, headX);
+  EXPECT_EQ(game.snakeCoordinates.front().y, headY);
+}
+
+TEST_F(SnakeGameTest, StepsFollowScheduler) {
+  Snake game(8);
+  Controller controller(&game);
+  controller.userInput(Start, false);
+  int headY = game.snakeCoordinates.front().y;
+  controller.updateCurrentState();
+  EXPECT_EQ(game.snakeCoordinates.front().y, headY);
+  EXPECT_GT(controller.UntilNextTickNs(), 0);
+  EXPECT_LE(controller.UntilNextTickNs(),
+            game.gameInfo.speed * TICK_NS_PER_MS);
+}
+
+TEST_F(SnakeGameTest, LatencyRecordsStepsAndInput) {
+  Snake game(8);
+  Controller controller(&game);
+  static LatencyStats_t stats;
+  latencyStatsInit(&stats);
+  controller.SetLatency(&stats);
+  latencyKeyPressed(&stats, tickNow());
+  controller.userInput(Start, false);
+  EXPECT_EQ(latencyCount(&stats.input), 1u);
+  game.gameInfo.speed = 5;
+  struct timespec pause = {0, 12000000};
+  nanosleep(&pause, nullptr);
+  controller.updateCurrentState();
+  uint64_t steps = latencyCount(&stats.tick);
+  EXPECT_GE(steps, 2u);
+  controller.SetLatency(nullptr);
+  nanosleep(&pause, nullptr);
+  controller.updateCurrentState();
+  EXPECT_EQ(latencyCount(&stats.tick), steps);
+}
+
+TEST_F(SnakeGameTest, TraceRecordsSnakePhases) {
+  const char *path = "trace_snake_test.json";
+  Snake game(8);
+  Controller controller(&game);
+  controller.userInput(Start, false);
+  game.MovingSnake();
+  ASSERT_TRUE(traceFlush(path));
+  FILE *file = fopen(path, "r");
+  ASSERT_NE(file, nullptr);
+  std::string text;
+  char chunk[4096];
+  for (size_t n; (n = fread(chunk, 1, sizeof(chunk), file)) > 0;) {
+    text.append(chunk, n);
+  }
+  fclose(file);
+  remove(path);
+  EXPECT_EQ(text.rfind("{\"traceEvents\":[", 0), 0u);
+  bool moved = text.find("\"name\":\"Snake::MovingSnake\"") !=
+               std::string::npos;
+  EXPECT_EQ(moved, traceEnabled());
+}
+
+TEST_F(SnakeGameTest, ThreadHandsOffInputAndSnapshots) {
+  Snake game(6);
+  Controller controller(&game);
+  std::atomic<int> notified{0};
+  controller.OnFrame([&notified] { notified++; });
+  controller.Snapshot();
+  ASSERT_TRUE(controller.StartThread());
+  EXPECT_TRUE(controller.Threaded());
+  EXPECT_TRUE(controller.Post(Start, false));
+  EXPECT_TRUE(controller.Post(Pause, false));
+  struct timespec pause = {0, 1000000};
+  for (int i = 0; i < 1000 && controller.Snapshot().info.pause != PAUSED;
+       i++) {
+    nanosleep(&pause, nullptr);
+  }
+  const SnakeSnapshot &state = controller.Snapshot();
+  EXPECT_EQ(state.info.pause, PAUSED);
+  EXPECT_GT(state.sequence, 1u);
+  EXPECT_GT(notified.load(), 0);
+  controller.StopThread();
+  EXPECT_FALSE(controller.Threaded());
+  EXPECT_EQ(game.gameInfo.pause, PAUSED);
+
+  EXPECT_TRUE(controller.Post(Pause, false));
+  EXPECT_GE(controller.Run(), 0);
+  EXPECT_EQ(controller.Snapshot().info.pause, STARTED);
+}
+
+/**
+ * @brief Направление обхода поля по гамильтонову циклу из клетки (x, y).
+ *
+ * Строки обходятся змейкой по столбцам 1..WIDTH-1, столбец 0 ведет от
+ * последней строки обратно к началу: змейка на цикле не врезается в себя.
+ */
+static UserAction_t CycleMove(int x, int y) {
+  UserAction_t move;
+  if (x == 0) {
+    move = y > 0 ? Up : Right;
+  } else if (y % 2 == 0) {
+    move = x < WIDTH - 1 ? Right : Down;
+  } else if (x > 1) {
+    move = Left;
+  } else {
+    move = y == HEIGHT - 1 ? Left : Down;
+  }
+  return move;
+}
+
+TEST_F(SnakeGameTest, SteadyStateDoesNotAllocate) {
+  Snake game(11);
+  Controller controller(&game);
+  controller.userInput(Start, false);
+  game.SetSnake({{3, 0}, {2, 0}, {1, 0}, {0, 0}});
+  game.SetDirection(Right);
+  AllocStats_t before{};
+  for (int step = 0; step < 600 && game.gameInfo.pause == STARTED; step++) {
+    if (step == 200) allocStatsTake(&before);
+    const Snake::SnakeElement &head = game.snakeCoordinates.front();
+    controller.userInput(CycleMove(head.x, head.y), false);
+    game.MovingSnake();
+    controller.updateCurrentState();
+  }
+  EXPECT_EQ(game.gameInfo.pause, STARTED);
+  EXPECT_GT(game.gameInfo.score, 0);
+  EXPECT_EQ(allocStatsSince(&before, ALLOC_PHASES), 0u);
+}
+
+TEST_F(SnakeGameTest, AlignedNewIsCounted) {
+  struct alignas(64) Block {
+    char bytes[64];
+  };
+  AllocStats_t before;
+  allocStatsTake(&before);
+  Block *volatile block = new Block;
+  delete block;
+  EXPECT_EQ(allocStatsSince(&before, ALLOC_PHASES),
+            allocStatsEnabled() ? 1u : 0u);
+}
+
 TEST_F(SnakeGameTest, MoveDown) {
   Snake game;
   Controller controller (&game);
@@ -216,6 +495,34 @@ TEST_F(SnakeGameTest, ScoreWrite) {
   EXPECT_TRUE(game.gameInfo.score == 156);
 }
 
+TEST_F(SnakeGameTest, ScoreFlushedOnTerminate) {
+  remove(SCORE_FILE_SNAKE);
+  Snake game;
+  Controller controller(&game);
+  for (int score = 1; score <= 7; score++) {
+    game.gameInfo.score = score;
+    game.WriteHighScore();
+  }
+  controller.userInput(Terminate, false);
+  int score = 0;
+  std::ifstream in(SCORE_FILE_SNAKE);
+  in >> score;
+  EXPECT_EQ(score, 7);
+  remove(SCORE_FILE_SNAKE);
+}
+
+TEST_F(SnakeGameTest, NoScoreFileLeavesRecordAlone) {
+  remove(SCORE_FILE_SNAKE);
+  Snake game(3, nullptr);
+  Controller controller(&game);
+  EXPECT_EQ(game.gameInfo.high_score, 0);
+  game.gameInfo.score = 42;
+  controller.userInput(Terminate, false);
+  EXPECT_EQ(game.gameInfo.high_score, 42);
+  std::ifstream in(SCORE_FILE_SNAKE);
+  EXPECT_FALSE(in.good());
+}
+
 TEST_F(SnakeGameTest, UpdateLevel){
    Snake game;
   Controller controller (&game);
@@ -315,6 +622,74 @@ TEST_F(SnakeGameTest, GetFlagError){
 }
 
 
+TEST_F(SnakeGameTest, ContiguousField){
+  Snake game;
+  ASSERT_FALSE(game.GetFlagErrorGame());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(game.gameInfo.field[0]) % FIELD_ALIGNMENT, 0u);
+  for (int i = 1; i < HEIGHT; i++) {
+    EXPECT_EQ(game.gameInfo.field[i], game.gameInfo.field[0] + i * WIDTH);
+  }
+  EXPECT_EQ(game.gameInfo.field[0][1], 12);
+  EXPECT_EQ(game.gameInfo.field[HEIGHT - 1][WIDTH - 1], 13);
+}
+
+TEST_F(SnakeGameTest, SeedDeterminesApples){
+  Snake first(123);
+  Snake second(123);
+  ASSERT_FALSE(first.GetFlagErrorGame());
+  EXPECT_EQ(first.GetSeed(), 123u);
+  EXPECT_EQ(first.gameInfo.next[0][0], second.gameInfo.next[0][0]);
+  EXPECT_EQ(first.gameInfo.next[0][1], second.gameInfo.next[0][1]);
+}
+
+TEST_F(SnakeGameTest, ReplayRoundTrip){
+  const char *dir = "replay_test";
+  Snake game(2024);
+  Controller controller(&game);
+  controller.StartRecording();
+  controller.userInput(Start, false);
+  const UserAction_t turns[] = {Left, Up, Right, Up};
+  for (int tick = 0; tick < 40 && game.gameInfo.pause == STARTED; tick++) {
+    if (tick % 4 == 0) controller.userInput(turns[tick / 4 % 4], false);
+    if (tick % 7 == 0) controller.userInput(Action, true);
+    controller.Step();
+  }
+  ASSERT_TRUE(controller.SaveReplay(dir));
+  EXPECT_FALSE(controller.SaveReplay(dir));
+  const Replay_t &recorded = controller.GetReplay();
+  EXPECT_EQ(recorded.game, REPLAY_SNAKE);
+  EXPECT_GT(recorded.ticks, 0u);
+
+  char path[64];
+  snprintf(path, sizeof(path), "%s/snake-2024.bgr", dir);
+  Replay_t loaded;
+  ASSERT_TRUE(replayLoad(&loaded, path));
+  remove(path);
+  remove(dir);
+  EXPECT_EQ(loaded.seed, 2024u);
+  EXPECT_EQ(loaded.events, recorded.events);
+  EXPECT_EQ(loaded.score, game.gameInfo.score);
+
+  Snake copy(loaded.seed);
+  Controller player(&copy);
+  ReplayCursor_t cursor{};
+  ReplayEvent_t event;
+  uint64_t tick = 0;
+  while (replayNext(&loaded, &cursor, &event)) {
+    for (; tick < event.tick; tick++) player.Step();
+    player.userInput(static_cast<UserAction_t>(event.action), event.hold);
+  }
+  for (; tick < loaded.ticks; tick++) player.Step();
+  EXPECT_EQ(copy.gameInfo.score, game.gameInfo.score);
+  EXPECT_EQ(copy.gameInfo.pause, game.gameInfo.pause);
+  EXPECT_EQ(copy.snakeCoordinates.size(), game.snakeCoordinates.size());
+  EXPECT_EQ(copy.snakeCoordinates.front().x, game.snakeCoordinates.front().x);
+  EXPECT_EQ(copy.snakeCoordinates.front().y, game.snakeCoordinates.front().y);
+  EXPECT_EQ(copy.gameInfo.next[0][0], game.gameInfo.next[0][0]);
+  EXPECT_EQ(copy.gameInfo.next[0][1], game.gameInfo.next[0][1]);
+  replayFree(&loaded);
+}
+
 } // namespace s21
 
 
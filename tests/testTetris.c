@@ -1,6 +1,14 @@
 #include <check.h> 
+#include <sched.h>
 
-#include "../brick_game/tetris/tetris_backend.h"
+#include "../brick_game/common/alloc_stats.h"
+#include "../brick_game/common/latency.h"
+#include "../brick_game/common/tick_scheduler.h"
+#include "../brick_game/common/trace.h"
+#include "../brick_game/tetris/tetris_batch.h"
+#include "../brick_game/tetris/tetris_bot.h"
+#include "../brick_game/tetris/tetris_score.h"
+#include "../brick_game/tetris/tetris_sim.h"
 
 //////////////////// INITIAL GAME ////////////////////
 
@@ -25,17 +33,74 @@ START_TEST(initial2_check_fields) {
     }
   }
   ck_assert_ptr_nonnull(game.gameInfo.next);
-  ck_assert_ptr_nonnull(game.figure.shape);
+  ck_assert_int_ge(game.figure.indexTetramino, 0);
+  ck_assert_int_lt(game.figure.indexTetramino, TETROMINO_COUNT);
   freeSpace(&game);
 }
 END_TEST
 
+START_TEST(initial3_seeded_games) {
+  Tetris first, second;
+  initialGameSeeded(&first, 42);
+  initialGameSeeded(&second, 42);
+  userInput(&first, Start, 0);
+  userInput(&second, Start, 0);
+  UserAction_t actions[] = {Left, Action, Right, Down, Right, Action};
+  for (int i = 0; i < 2000; i++) {
+    userInput(&first, actions[i % 6], 0);
+    userInput(&second, actions[i % 6], 0);
+    updateCurrentState(&first);
+    updateCurrentState(&second);
+    ck_assert_int_eq(first.figure.indexTetramino,
+                     second.figure.indexTetramino);
+    ck_assert_int_eq(first.figure.indexNext, second.figure.indexNext);
+  }
+  ck_assert_int_eq(memcmp(first.board.rows, second.board.rows,
+                          sizeof(first.board.rows)),
+                   0);
+  ck_assert_int_eq(first.gameInfo.score, second.gameInfo.score);
+  ck_assert_int_eq(first.gameInfo.pause, second.gameInfo.pause);
+  ck_assert_int_eq(first.seed, 42);
+  freeSpace(&first);
+  freeSpace(&second);
+}
+END_TEST
+
+START_TEST(initial4_piece_distribution) {
+  Tetris game;
+  initialGameSeeded(&game, 7);
+  int counts[TETROMINO_TYPES] = {0};
+  for (int i = 0; i < 7000; i++) {
+    initializeFigure(&game);
+    counts[game.figure.indexNext]++;
+  }
+  for (int i = 0; i < TETROMINO_TYPES; i++) {
+    ck_assert_int_gt(counts[i], 800);
+    ck_assert_int_lt(counts[i], 1200);
+  }
+  freeSpace(&game);
+}
+END_TEST
+
+START_TEST(initial5_random_seeds) {
+  Tetris first, second;
+  ck_assert_int_eq(initialGame(&first), OK_);
+  ck_assert_int_eq(initialGame(&second), OK_);
+  ck_assert_uint_ne(first.seed, second.seed);
+  freeSpace(&first);
+  freeSpace(&second);
+}
+END_TEST
+
 Suite *test_create(void) {
   Suite *s;
   s = suite_create("s21_initial_game");
   TCase *tcase_initial = tcase_create("CREATE");
   tcase_add_test(tcase_initial, initial1_check_stats);
   tcase_add_test(tcase_initial, initial2_check_fields);
+  tcase_add_test(tcase_initial, initial3_seeded_games);
+  tcase_add_test(tcase_initial, initial4_piece_distribution);
+  tcase_add_test(tcase_initial, initial5_random_seeds);
   suite_add_tcase(s, tcase_initial);
   return s;
 }
@@ -102,6 +167,29 @@ START_TEST(read_high_score2) {
 }
 END_TEST
 
+START_TEST(write_high_score_coalesced) {
+  Tetris game;
+  initialGame(&game);
+  remove(SCORE_FILE);
+  attachHighScoreFile(&game);
+  ck_assert_int_eq(game.gameInfo.high_score, 0);
+  ScoreStore_t *store = scoreStoreOpen(SCORE_FILE);
+  ck_assert_ptr_nonnull(store);
+  uint64_t writes = scoreStoreWrites(store);
+  for (int score = 100; score <= 1000; score += 100) {
+    game.gameInfo.score = score;
+    game.saveHighScore(&game);
+  }
+  gameTerminated(&game);
+  ck_assert_int_eq(scoreStoreWrites(store) - writes, 1);
+  ck_assert_ptr_null(fopen(SCORE_FILE ".tmp", "r"));
+  game.gameInfo.high_score = 0;
+  readHighScore(&game);
+  ck_assert_int_eq(game.gameInfo.high_score, 1000);
+  freeSpace(&game);
+}
+END_TEST
+
 Suite *test_high_score(void) {
   Suite *s;
   s = suite_create("s21_read_write_high_score");
@@ -110,6 +198,7 @@ Suite *test_high_score(void) {
   tcase_add_test(tcase_high_score, write_high_score1);
   tcase_add_test(tcase_high_score, write_high_score2);
   tcase_add_test(tcase_high_score, read_high_score2);
+  tcase_add_test(tcase_high_score, write_high_score_coalesced);
 
   suite_add_tcase(s, tcase_high_score);
   return s;
@@ -174,7 +263,7 @@ START_TEST(game_check_lose2) {
   Tetris game;
   initialGame(&game);
   game.gameInfo.pause = STARTED;
-  game.gameInfo.field[0][1] = 2;
+  setBoardCell(&game, 0, 1, 2);
   ck_assert_int_eq(checkLose(&game), 1);
 
   freeSpace(&game);
@@ -251,10 +340,9 @@ START_TEST(user_input_left2) {
   Tetris game;
   initialGame(&game);
   game.figure.indexTetramino = 0;
-  cpyTetraminoFigure(&game.figure.shape, 0);
   for (int i = 1; i < HEIGHT; i++) {
     for (int j = 0; j < 3; j++) {
-      game.gameInfo.field[i][j] = 1;
+      setBoardCell(&game, i, j, 1);
     }
   }
   userInput(&game, Start, 0);
@@ -295,10 +383,9 @@ START_TEST(user_input_right2) {
   Tetris game;
   initialGame(&game);
   game.figure.indexTetramino = 0;
-  cpyTetraminoFigure(&game.figure.shape, 0);
   for (int i = 1; i < HEIGHT; i++) {
     for (int j = 7; j < WIDTH; j++) {
-      game.gameInfo.field[i][j] = 1;
+      setBoardCell(&game, i, j, 1);
     }
   }
   userInput(&game, Start, 0);
@@ -341,7 +428,6 @@ START_TEST(user_input_rotate2) {
   userInput(&game, Start, 0);
 
   game.figure.indexTetramino = 7;
-  cpyTetraminoFigure(&game.figure.shape, 7);
 
   for (int i = 0; i < 5; i++) {
     userInput(&game, Down, 0);
@@ -363,10 +449,9 @@ START_TEST(user_input_rotate3) {
   Tetris game;
   initialGame(&game);
   game.figure.indexTetramino = 7;
-  cpyTetraminoFigure(&game.figure.shape, 7);
   for (int i = 1; i < HEIGHT; i++) {
     for (int j = 0; j < WIDTH; j++) {
-      if (j != game.figure.x + 1) game.gameInfo.field[i][j] = 1;
+      if (j != game.figure.x + 1) setBoardCell(&game, i, j, 1);
     }
   }
   userInput(&game, Start, 0);
@@ -379,6 +464,38 @@ START_TEST(user_input_rotate3) {
 }
 END_TEST
 
+START_TEST(can_rotate1) {
+  Tetris game;
+  initialGame(&game);
+  game.figure.indexTetramino = PIECE_INDEX(0, 1);
+  game.figure.x = 3;
+  game.figure.y = 5;
+  ck_assert(canRotate(&game, 1));
+  ck_assert(canRotate(&game, -1));
+
+  setBoardCell(&game, 8, 3, 1);
+  ck_assert(!canRotate(&game, 1));
+  ck_assert(!canRotate(&game, -1));
+  ck_assert_int_eq(checkRotate(&game), 0);
+  ck_assert_int_eq(game.figure.indexTetramino, PIECE_INDEX(0, 1));
+  freeSpace(&game);
+}
+END_TEST
+
+START_TEST(can_rotate2) {
+  Tetris game;
+  initialGame(&game);
+  game.figure.indexTetramino = PIECE_INDEX(5, 0);
+  game.figure.x = 4;
+  game.figure.y = 10;
+  setBoardCell(&game, 11, 4, 1);
+  ck_assert(!canRotate(&game, 1));
+  ck_assert(canRotate(&game, -1));
+  ck_assert(canRotate(&game, 2));
+  freeSpace(&game);
+}
+END_TEST
+
 Suite *test_game_user_input_action(void) {
   Suite *s;
   s = suite_create("s21_game_user_input_action");
@@ -398,6 +515,8 @@ Suite *test_game_user_input_action(void) {
   tcase_add_test(tcase_user_input, user_input_rotate);
   tcase_add_test(tcase_user_input, user_input_rotate2);
   tcase_add_test(tcase_user_input, user_input_rotate3);
+  tcase_add_test(tcase_user_input, can_rotate1);
+  tcase_add_test(tcase_user_input, can_rotate2);
 
   suite_add_tcase(s, tcase_user_input);
   return s;
@@ -476,7 +595,6 @@ START_TEST(locking_figure1) {
   Tetris game;
   initialGame(&game);
   game.figure.indexTetramino = 0;
-  cpyTetraminoFigure(&game.figure.shape, 0);
   userInput(&game, Start, 0);
   for (int i = 0; i < 20; i++) {
     updateCurrentState(&game);
@@ -490,8 +608,8 @@ START_TEST(locking_figure2) {
   Tetris game;
   initialGame(&game);
   game.figure.indexTetramino = 0;
-  cpyTetraminoFigure(&game.figure.shape, 0);
-  game.gameInfo.field[1][5] = 1;
+  game.figure.indexNext = 0;
+  setBoardCell(&game, 1, 5, 1);
   userInput(&game, Start, 0);
   for (int i = 0; i < 20; i++) {
     updateCurrentState(&game);
@@ -505,12 +623,13 @@ START_TEST(attaching_figure1) {
   Tetris game;
   initialGame(&game);
   for (int i = 0; i < WIDTH; i++) {
-    game.gameInfo.field[5][i] = 1;
+    setBoardCell(&game, 5, i, 1);
   }
-  game.gameInfo.field[4][4] = 2;
-  game.gameInfo.field[6][4] = 2;
+  setBoardCell(&game, 4, 4, 2);
+  setBoardCell(&game, 6, 4, 2);
   userInput(&game, Start, 0);
   attachingFigures(&game);
+  getGameInfo(&game);
 
   ck_assert_int_eq(game.gameInfo.field[6][4], 2);
   ck_assert_int_eq(game.gameInfo.field[5][4], 2);
@@ -518,6 +637,105 @@ START_TEST(attaching_figure1) {
   freeSpace(&game);
 }
 END_TEST
+START_TEST(tetromino_table) {
+  for (int index = 0; index < TETROMINO_COUNT; index++) {
+    const Tetromino_t *t = &TETROMINOS[index];
+    int cells = 0;
+    for (int k = 0; k < 4; k++) {
+      int y = t->cells[k][0];
+      int x = t->cells[k][1];
+      ck_assert_int_eq((t->rows[y] >> x) & 1, 1);
+      ck_assert(y >= t->minY && y <= t->maxY);
+      ck_assert(x >= t->minX && x <= t->maxX);
+    }
+    for (int i = 0; i < 4; i++) cells += __builtin_popcount(t->rows[i]);
+    ck_assert_int_eq(cells, 4);
+    ck_assert_int_eq(t->maxY, 3);
+  }
+}
+END_TEST
+
+START_TEST(attaching_figure2) {
+  Tetris game;
+  initialGame(&game);
+  for (int i = 0; i < WIDTH; i++) {
+    setBoardCell(&game, 19, i, 1);
+    setBoardCell(&game, 17, i, 3);
+    setBoardCell(&game, 14, i, 4);
+  }
+  setBoardCell(&game, 18, 2, 5);
+  setBoardCell(&game, 16, 7, 6);
+  setBoardCell(&game, 15, 0, 7);
+
+  uint32_t cleared = attachingFigures(&game);
+  getGameInfo(&game);
+
+  ck_assert_uint_eq(cleared, (1u << 19) | (1u << 17) | (1u << 14));
+  ck_assert_uint_eq(game.clearedRows, cleared);
+  ck_assert_int_eq(game.gameInfo.score, 700);
+  ck_assert_int_eq(game.gameInfo.field[19][2], 5);
+  ck_assert_int_eq(game.gameInfo.field[18][7], 6);
+  ck_assert_int_eq(game.gameInfo.field[17][0], 7);
+  ck_assert_int_eq(game.board.rows[16], 0);
+  ck_assert_int_eq(game.board.rows[0], 0);
+  freeSpace(&game);
+}
+END_TEST
+
+START_TEST(board_game_info_view) {
+  Tetris game;
+  initialGame(&game);
+  setBoardCell(&game, 7, 3, 5);
+  setBoardCell(&game, 7, 9, 1);
+  ck_assert_int_eq(game.board.rows[7], (1 << 3) | (1 << 9));
+  getGameInfo(&game);
+  ck_assert_int_eq(game.gameInfo.field[7][3], 5);
+  ck_assert_int_eq(game.gameInfo.field[7][9], 1);
+
+  setBoardCell(&game, 7, 3, 0);
+  getGameInfo(&game);
+  ck_assert_int_eq(game.board.rows[7], 1 << 9);
+  ck_assert_int_eq(game.gameInfo.field[7][3], 0);
+  freeSpace(&game);
+}
+END_TEST
+
+START_TEST(frame_diff_tracks_changes) {
+  Tetris game;
+  initialGameSeeded(&game, 3);
+  FrameDiff_t diff = takeFrameDiff(&game);
+  ck_assert_uint_eq(diff.rows, ALL_ROWS);
+  ck_assert_int_eq(diff.hud & FRAME_STATE, FRAME_STATE);
+  diff = takeFrameDiff(&game);
+  ck_assert_uint_eq(diff.rows, 0);
+  ck_assert_int_eq(diff.hud, 0);
+
+  const Tetromino_t *t = &TETROMINOS[game.figure.indexTetramino];
+  uint32_t figure = 0;
+  for (int k = 0; k < 4; k++) {
+    int y = game.figure.y + t->cells[k][0];
+    if (y >= 0) figure |= 1u << y;
+    figure |= 1u << (5 + t->cells[k][0]);
+  }
+  setBoardCell(&game, 12, 4, 2);
+  game.figure.y = 5;
+  diff = takeFrameDiff(&game);
+  ck_assert_uint_eq(diff.rows, (1u << 12) | figure);
+
+  game.gameInfo.score = 100;
+  diff = takeFrameDiff(&game);
+  ck_assert_uint_eq(diff.rows, 0);
+  ck_assert_int_eq(diff.hud, FRAME_SCORE);
+
+  for (int i = 0; i < WIDTH; i++) setBoardCell(&game, 15, i, 1);
+  takeFrameDiff(&game);
+  attachingFigures(&game);
+  diff = takeFrameDiff(&game);
+  ck_assert_uint_eq(diff.rows, FRAME_ROWS(16));
+  freeSpace(&game);
+}
+END_TEST
+
 Suite *test_game_locking_figures(void) {
   Suite *s;
   s = suite_create("s21_game_lock_figure");
@@ -525,11 +743,828 @@ Suite *test_game_locking_figures(void) {
   tcase_add_test(tcase_lock_figure, locking_figure1);
   tcase_add_test(tcase_lock_figure, locking_figure2);
   tcase_add_test(tcase_lock_figure, attaching_figure1);
+  tcase_add_test(tcase_lock_figure, attaching_figure2);
+  tcase_add_test(tcase_lock_figure, board_game_info_view);
+  tcase_add_test(tcase_lock_figure, frame_diff_tracks_changes);
+  tcase_add_test(tcase_lock_figure, tetromino_table);
 
   suite_add_tcase(s, tcase_lock_figure);
   return s;
 }
 END_TEST
+//////////////////// BOT ////////////////////
+
+START_TEST(bot_fills_well) {
+  Tetris game;
+  TetrisBot_t bot;
+  initialGameSeeded(&game, 7);
+  ck_assert_int_eq(botCreate(&bot, 2, botDefaultWeights()), OK_);
+  for (int i = HEIGHT - 4; i < HEIGHT; i++) {
+    for (int j = 0; j < WIDTH - 1; j++) setBoardCell(&game, i, j, 1);
+  }
+  game.figure.indexTetramino = 0;
+  Placement_t best;
+  ck_assert(botFindPlacement(&bot, &game, false, &best));
+  ck_assert_int_eq(best.lines, 4);
+  ck_assert_int_eq(best.x + TETROMINOS[best.indexTetramino].minX, WIDTH - 1);
+  ck_assert(bot.evaluated > 0);
+  botDestroy(&bot);
+  freeSpace(&game);
+}
+END_TEST
+
+START_TEST(bot_plays_game) {
+  Tetris game;
+  TetrisBot_t bot;
+  initialGameSeeded(&game, 2024);
+  ck_assert_int_eq(botCreate(&bot, 3, botDefaultWeights()), OK_);
+  gameStart(&game);
+  int pieces = 0;
+  while (pieces < 300 && game.gameInfo.pause == STARTED) {
+    Placement_t target;
+    ck_assert(botFindPlacement(&bot, &game, true, &target));
+    int y = game.figure.y;
+    while (game.figure.y >= y && game.gameInfo.pause == STARTED) {
+      y = game.figure.y;
+      userInput(&game, botNextAction(&game, &target), false);
+      updateCurrentState(&game);
+    }
+    const Tetromino_t *t = &TETROMINOS[target.indexTetramino];
+    if (target.lines == 0) {
+      for (int k = 0; k < 4; k++) {
+        int y = target.y + t->cells[k][0];
+        int x = target.x + t->cells[k][1];
+        ck_assert(game.board.rows[y] & (1u << x));
+      }
+    }
+    pieces++;
+  }
+  ck_assert_int_eq(pieces, 300);
+  ck_assert_int_eq(game.pieces, 300);
+  ck_assert_int_gt(game.lines, 0);
+  ck_assert_int_eq(game.gameInfo.pause, STARTED);
+  ck_assert_int_gt(game.gameInfo.score, 0);
+  botDestroy(&bot);
+  freeSpace(&game);
+}
+END_TEST
+
+START_TEST(bot_thread_count) {
+  Tetris game;
+  TetrisBot_t single;
+  TetrisBot_t pool;
+  initialGameSeeded(&game, 5);
+  ck_assert_int_eq(botCreate(&single, 1, botDefaultWeights()), OK_);
+  ck_assert_int_eq(botCreate(&pool, 4, botDefaultWeights()), OK_);
+  setBoardCell(&game, HEIGHT - 1, 0, 1);
+  setBoardCell(&game, HEIGHT - 2, 0, 1);
+  setBoardCell(&game, HEIGHT - 1, 5, 1);
+  Placement_t a;
+  Placement_t b;
+  ck_assert(botFindPlacement(&single, &game, true, &a));
+  ck_assert(botFindPlacement(&pool, &game, true, &b));
+  ck_assert_int_eq(a.indexTetramino, b.indexTetramino);
+  ck_assert_int_eq(a.x, b.x);
+  ck_assert_int_eq(a.y, b.y);
+  ck_assert_int_eq(single.evaluated, pool.evaluated);
+  botDestroy(&single);
+  botDestroy(&pool);
+  freeSpace(&game);
+}
+END_TEST
+
+Suite *test_bot(void) {
+  Suite *s;
+  s = suite_create("s21_bot");
+  TCase *tcase_bot = tcase_create("BOT");
+  tcase_add_test(tcase_bot, bot_fills_well);
+  tcase_add_test(tcase_bot, bot_plays_game);
+  tcase_add_test(tcase_bot, bot_thread_count);
+
+  suite_add_tcase(s, tcase_bot);
+  return s;
+}
+
+//////////////////// BATCH ////////////////////
+/**
+ * @brief Играет партии запуска в threads потоках.
+ *
+ * @param config Параметры запуска (threads перезаписывается).
+ * @param threads Количество потоков.
+ * @param totals Итоги запуска.
+ * @return GameResult_t* Результаты партий (освобождает вызывающий).
+ */
+static GameResult_t *batch_play(BatchConfig_t *config, int threads,
+                                BatchTotals_t *totals) {
+  GameResult_t *results =
+      (GameResult_t *)calloc(config->games, sizeof(GameResult_t));
+  ck_assert_ptr_nonnull(results);
+  config->threads = threads;
+  runBatch(config, results, totals);
+  return results;
+}
+
+START_TEST(batch_thread_count) {
+  const char *policies[] = {"random", "bot"};
+  const long long games[] = {24, 6};
+  for (int p = 0; p < 2; p++) {
+    BatchConfig_t config = {games[p], 1, 100, 1500, findPolicy(policies[p]),
+                            NULL};
+    ck_assert_ptr_nonnull(config.policy);
+    BatchTotals_t one, many;
+    GameResult_t *serial = batch_play(&config, 1, &one);
+    GameResult_t *parallel = batch_play(&config, 4, &many);
+    ck_assert_int_eq(one.failed, 0);
+    ck_assert_int_eq(many.failed, 0);
+    uint32_t pieces = 0;
+    for (long long i = 0; i < config.games; i++) {
+      ck_assert_uint_eq(serial[i].seed, config.seed + i);
+      pieces += serial[i].pieces;
+    }
+    ck_assert_uint_gt(pieces, 0);
+    ck_assert(!memcmp(serial, parallel, config.games * sizeof(GameResult_t)));
+
+    GameResult_t single;
+    memset(&single, 0, sizeof(single));
+    void *state = config.policy->create();
+    ck_assert_int_eq(runGame(config.policy, state, config.seed + 3,
+                             config.maxTicks, &single),
+                     OK_);
+    config.policy->destroy(state);
+    ck_assert(!memcmp(&single, &serial[3], sizeof(single)));
+    free(serial);
+    free(parallel);
+  }
+}
+END_TEST
+
+static void *batch_broken_create(void) { return NULL; }
+
+START_TEST(batch_failures_counted) {
+  const TetrisPolicy_t broken = {"broken", batch_broken_create, NULL,
+                                 findPolicy("idle")->next, NULL};
+  BatchConfig_t config = {10, 1, 1, 100, &broken, NULL};
+  BatchTotals_t totals;
+  GameResult_t *results = batch_play(&config, 3, &totals);
+  ck_assert_int_eq(totals.failed, 10);
+  ck_assert_int_eq(runBatch(&config, results, &totals), ERROR);
+  for (long long i = 0; i < config.games; i++) {
+    ck_assert_uint_eq(results[i].seed, 0);
+    ck_assert_uint_eq(results[i].ticks, 0);
+  }
+  free(results);
+
+  config.policy = findPolicy("idle");
+  results = batch_play(&config, 3, &totals);
+  ck_assert_int_eq(totals.failed, 0);
+  ck_assert_int_eq(runBatch(&config, results, &totals), OK_);
+  ck_assert_uint_eq(results[9].seed, 10);
+  ck_assert_uint_eq(results[9].ticks, 100);
+  free(results);
+}
+END_TEST
+
+Suite *test_batch(void) {
+  Suite *s;
+  s = suite_create("s21_batch");
+  TCase *tcase_batch = tcase_create("BATCH");
+  tcase_add_test(tcase_batch, batch_thread_count);
+  tcase_add_test(tcase_batch, batch_failures_counted);
+
+  suite_add_tcase(s, tcase_batch);
+  return s;
+}
+
+//////////////////// TICK SCHEDULER ////////////////////
+
+START_TEST(tick_fixed_step) {
+  const int64_t ms = TICK_NS_PER_MS;
+  TickScheduler_t ticks;
+  tickInit(&ticks, 100 * ms, 1000 * ms);
+  ck_assert_int_eq(tickAdvance(&ticks, 1050 * ms), 0);
+  ck_assert_int_eq(tickUntilNext(&ticks, 1050 * ms), 50 * ms);
+  ck_assert_int_eq(tickAdvance(&ticks, 1250 * ms), 2);
+  ck_assert_int_eq(tickUntilNext(&ticks, 1250 * ms), 50 * ms);
+  ck_assert_int_eq(tickAdvance(&ticks, 1300 * ms), 1);
+  ck_assert_int_eq(tickAdvance(&ticks, 1300 * ms), 0);
+  tickSkip(&ticks, 5000 * ms);
+  ck_assert_int_eq(tickAdvance(&ticks, 5050 * ms), 0);
+  ck_assert_int_eq(tickAdvance(&ticks, 5100 * ms), 1);
+}
+END_TEST
+
+START_TEST(tick_catch_up_cap) {
+  const int64_t ms = TICK_NS_PER_MS;
+  TickScheduler_t ticks;
+  tickInit(&ticks, 100 * ms, 0);
+  ck_assert_int_eq(tickAdvance(&ticks, (100 * TICK_MAX_STEPS + 30) * ms),
+                   TICK_MAX_STEPS);
+  ck_assert_int_eq(tickAdvance(&ticks, 10030 * ms), TICK_MAX_STEPS);
+  ck_assert_int_eq(ticks.dropped, 10000 / 100 - 2 * TICK_MAX_STEPS);
+  ck_assert_int_eq(tickUntilNext(&ticks, 10030 * ms), 70 * ms);
+  ck_assert_int_eq(tickAdvance(&ticks, 10099 * ms), 0);
+}
+END_TEST
+
+START_TEST(tick_period_and_ms) {
+  TickScheduler_t ticks;
+  tickInit(&ticks, -5, 0);
+  ck_assert_int_eq(ticks.periodNs, TICK_MIN_PERIOD_NS);
+  tickSetPeriod(&ticks, 3 * TICK_NS_PER_MS);
+  ck_assert_int_eq(tickUntilNextMs(&ticks, 1), 3);
+  ck_assert_int_eq(tickUntilNextMs(&ticks, TICK_NS_PER_MS + 1), 2);
+  ck_assert_int_eq(tickUntilNextMs(&ticks, 3 * TICK_NS_PER_MS), 0);
+
+  Tetris game;
+  initialGameSeeded(&game, 1);
+  ck_assert_int_eq(gravityPeriodNs(&game), GRAVITY_BASE_NS - GRAVITY_STEP_NS);
+  game.gameInfo.score = 6000;
+  updateLevel(&game);
+  ck_assert_int_eq(gravityPeriodNs(&game),
+                   GRAVITY_BASE_NS - 10 * GRAVITY_STEP_NS);
+  freeSpace(&game);
+}
+END_TEST
+
+Suite *test_tick(void) {
+  Suite *s;
+  s = suite_create("s21_tick");
+  TCase *tcase_tick = tcase_create("TICK");
+  tcase_add_test(tcase_tick, tick_fixed_step);
+  tcase_add_test(tcase_tick, tick_catch_up_cap);
+  tcase_add_test(tcase_tick, tick_period_and_ms);
+
+  suite_add_tcase(s, tcase_tick);
+  return s;
+}
+
+//////////////////// SIMULATION THREAD ////////////////////
+
+START_TEST(sim_queue_order) {
+  SimQueue_t queue;
+  SimInput_t input;
+  simQueueInit(&queue);
+  ck_assert(!simQueuePop(&queue, &input));
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < SIM_QUEUE_SIZE; i++) {
+      ck_assert(simQueuePush(&queue, i, i % 2));
+    }
+    ck_assert(!simQueuePush(&queue, -1, false));
+    for (int i = 0; i < SIM_QUEUE_SIZE; i++) {
+      ck_assert(simQueuePop(&queue, &input));
+      ck_assert_int_eq(input.action, i);
+      ck_assert_int_eq(input.hold, i % 2);
+    }
+    ck_assert(!simQueuePop(&queue, &input));
+  }
+}
+END_TEST
+
+static void *sim_queue_producer(void *arg) {
+  SimQueue_t *queue = (SimQueue_t *)arg;
+  for (int i = 0; i < 100000; i++) {
+    while (!simQueuePush(queue, i, false)) sched_yield();
+  }
+  return NULL;
+}
+
+START_TEST(sim_queue_threads) {
+  SimQueue_t queue;
+  simQueueInit(&queue);
+  pthread_t producer;
+  ck_assert_int_eq(
+      pthread_create(&producer, NULL, sim_queue_producer, &queue), 0);
+  SimInput_t input;
+  int expected = 0;
+  while (expected < 100000) {
+    if (simQueuePop(&queue, &input)) {
+      ck_assert_int_eq(input.action, expected);
+      expected++;
+    } else {
+      sched_yield();
+    }
+  }
+  pthread_join(producer, NULL);
+  ck_assert(!simQueuePop(&queue, &input));
+}
+END_TEST
+
+START_TEST(sim_frames_triple) {
+  SimFrames_t frames;
+  simFramesInit(&frames);
+  ck_assert(!simFramesAcquire(&frames));
+  int first = frames.back;
+  ck_assert(simFramesPublish(&frames));
+  ck_assert_int_eq(frames.published, first);
+  ck_assert_int_ne(frames.back, first);
+  int second = frames.back;
+  ck_assert(!simFramesPublish(&frames));
+  ck_assert(simFramesAcquire(&frames));
+  ck_assert_int_eq(frames.front, second);
+  ck_assert(!simFramesAcquire(&frames));
+  for (int i = 0; i < 10; i++) {
+    ck_assert(simFramesPublish(&frames));
+    ck_assert_int_ne(frames.back, frames.front);
+    ck_assert_int_ne(frames.back, frames.published);
+    ck_assert(simFramesAcquire(&frames));
+    ck_assert_int_eq(frames.front, frames.published);
+  }
+}
+END_TEST
+
+START_TEST(tetris_sim_frames) {
+  Tetris game;
+  TetrisSim_t sim;
+  initialGameSeeded(&game, 3);
+  tetrisSimInit(&sim, &game, NULL, NULL);
+  ck_assert_int_eq(tetrisSimFrame(&sim)->sequence, 0);
+  ck_assert_int_lt(tetrisSimRun(&sim), 0);
+  const TetrisFrame_t *frame = tetrisSimFrame(&sim);
+  ck_assert_int_eq(frame->sequence, 1);
+  ck_assert_int_eq(frame->hud.state, NOT_STARTED);
+  ck_assert_int_eq(tetrisFrameChanges(frame, 0).rows, ALL_ROWS);
+
+  ck_assert(tetrisSimInput(&sim, Start, false));
+  ck_assert_int_ge(tetrisSimRun(&sim), 0);
+  frame = tetrisSimFrame(&sim);
+  ck_assert_int_eq(frame->hud.state, STARTED);
+  ck_assert_int_eq(tetrisFrameChanges(frame, 1).hud, FRAME_STATE);
+  int cells = 0;
+  for (int i = 0; i < HEIGHT; i++) {
+    for (int j = 0; j < WIDTH; j++) {
+      if (frame->cells[i][j]) {
+        cells++;
+        ck_assert_int_eq(frame->cells[i][j],
+                         PIECE_TYPE(game.figure.indexTetramino) + 1);
+      }
+    }
+  }
+  int visible = 0;
+  for (int k = 0; k < 4; k++) {
+    visible += game.figure.y +
+                   TETROMINOS[game.figure.indexTetramino].cells[k][0] >=
+               0;
+  }
+  ck_assert_int_eq(cells, visible);
+
+  moveDown(&game);
+  tetrisSimRun(&sim);
+  FrameDiff_t diff = tetrisFrameChanges(tetrisSimFrame(&sim), frame->sequence);
+  ck_assert_int_ne(diff.rows, 0);
+  ck_assert_int_eq(diff.hud, 0);
+  freeSpace(&game);
+}
+END_TEST
+
+static void tetris_sim_notify(void *context) {
+  __atomic_add_fetch((int *)context, 1, __ATOMIC_RELAXED);
+}
+
+START_TEST(tetris_sim_thread) {
+  Tetris game;
+  TetrisSim_t sim;
+  int notified = 0;
+  initialGameSeeded(&game, 4);
+  tetrisSimInit(&sim, &game, tetris_sim_notify, &notified);
+  ck_assert(tetrisSimStart(&sim));
+  ck_assert(tetrisSimInput(&sim, Start, false));
+  ck_assert(tetrisSimInput(&sim, Pause, false));
+  const TetrisFrame_t *frame = tetrisSimFrame(&sim);
+  for (int i = 0; i < 1000 && frame->hud.state != PAUSED; i++) {
+    struct timespec pause = {0, 1000000};
+    nanosleep(&pause, NULL);
+    frame = tetrisSimFrame(&sim);
+  }
+  ck_assert_int_eq(frame->hud.state, PAUSED);
+  ck_assert_int_gt(__atomic_load_n(&notified, __ATOMIC_RELAXED), 0);
+  ck_assert(tetrisSimInput(&sim, Terminate, false));
+  for (int i = 0; i < 1000 && frame->hud.state != QUIT; i++) {
+    struct timespec pause = {0, 1000000};
+    nanosleep(&pause, NULL);
+    frame = tetrisSimFrame(&sim);
+  }
+  ck_assert_int_eq(frame->hud.state, QUIT);
+  tetrisSimStop(&sim);
+  ck_assert(!sim.thread.started);
+  ck_assert_int_eq(game.gameInfo.pause, QUIT);
+  freeSpace(&game);
+}
+END_TEST
+
+Suite *test_sim(void) {
+  Suite *s;
+  s = suite_create("s21_sim");
+  TCase *tcase_sim = tcase_create("SIM");
+  tcase_add_test(tcase_sim, sim_queue_order);
+  tcase_add_test(tcase_sim, sim_queue_threads);
+  tcase_add_test(tcase_sim, sim_frames_triple);
+  tcase_add_test(tcase_sim, tetris_sim_frames);
+  tcase_add_test(tcase_sim, tetris_sim_thread);
+
+  suite_add_tcase(s, tcase_sim);
+  return s;
+}
+
+//////////////////// REPLAY ////////////////////
+
+START_TEST(replay_encoding) {
+  Replay_t replay;
+  replayInit(&replay, REPLAY_TETRIS, 42);
+  replayInput(&replay, Start, false);
+  for (int i = 0; i < 100000; i++) replayTick(&replay);
+  replayInput(&replay, Action, true);
+  replayTick(&replay);
+  replayInput(&replay, Terminate, false);
+  ck_assert_int_eq(replay.events, 3);
+  ck_assert_int_eq(replay.size, 1 + 3 + 1);
+
+  ReplayCursor_t cursor = {0, 0, 0};
+  ReplayEvent_t event;
+  ck_assert(replayNext(&replay, &cursor, &event));
+  ck_assert_int_eq(event.tick, 0);
+  ck_assert_int_eq(event.action, Start);
+  ck_assert(replayNext(&replay, &cursor, &event));
+  ck_assert_int_eq(event.tick, 100000);
+  ck_assert_int_eq(event.action, Action);
+  ck_assert(event.hold);
+  ck_assert(replayNext(&replay, &cursor, &event));
+  ck_assert_int_eq(event.tick, 100001);
+  ck_assert_int_eq(event.action, Terminate);
+  ck_assert(!event.hold);
+  ck_assert(!replayNext(&replay, &cursor, &event));
+  ck_assert_int_eq(cursor.offset, replay.size);
+  replayFree(&replay);
+}
+END_TEST
+
+START_TEST(replay_round_trip) {
+  const char *path = "replay_test.bgr";
+  Tetris game;
+  Replay_t replay;
+  TetrisBot_t bot;
+  initialGameSeeded(&game, 99);
+  recordReplay(&game, &replay);
+  ck_assert_int_eq(botCreate(&bot, 1, botDefaultWeights()), OK_);
+  userInput(&game, Start, false);
+  Placement_t target;
+  uint32_t planned = UINT32_MAX;
+  for (int tick = 0; tick < 3000 && game.gameInfo.pause == STARTED; tick++) {
+    if (planned != game.pieces) {
+      ck_assert(botFindPlacement(&bot, &game, true, &target));
+      planned = game.pieces;
+    }
+    if (tick % 2 == 0) {
+      userInput(&game, botNextAction(&game, &target), false);
+    }
+    updateCurrentState(&game);
+  }
+  botDestroy(&bot);
+  ck_assert_int_gt(game.lines, 0);
+  replay.score = game.gameInfo.score;
+  ck_assert(replaySave(&replay, path));
+
+  Replay_t loaded;
+  ck_assert(replayLoad(&loaded, path));
+  remove(path);
+  ck_assert_int_eq(loaded.game, REPLAY_TETRIS);
+  ck_assert_int_eq(loaded.seed, 99);
+  ck_assert_int_eq(loaded.ticks, replay.ticks);
+  ck_assert_int_eq(loaded.events, replay.events);
+  ck_assert_int_eq(loaded.score, game.gameInfo.score);
+  ck_assert(!memcmp(loaded.data, replay.data, replay.size));
+
+  Tetris copy;
+  initialGameSeeded(&copy, loaded.seed);
+  ReplayCursor_t cursor = {0, 0, 0};
+  ReplayEvent_t event;
+  uint64_t tick = 0;
+  while (replayNext(&loaded, &cursor, &event)) {
+    for (; tick < event.tick; tick++) updateCurrentState(&copy);
+    userInput(&copy, (UserAction_t)event.action, event.hold);
+  }
+  for (; tick < loaded.ticks; tick++) updateCurrentState(&copy);
+  ck_assert_int_eq(copy.gameInfo.score, game.gameInfo.score);
+  ck_assert_int_eq(copy.pieces, game.pieces);
+  ck_assert_int_eq(copy.figure.indexTetramino, game.figure.indexTetramino);
+  ck_assert(!memcmp(copy.board.rows, game.board.rows,
+                    sizeof(game.board.rows)));
+  replayFree(&loaded);
+  replayFree(&replay);
+  freeSpace(&copy);
+  freeSpace(&game);
+}
+END_TEST
+
+START_TEST(replay_archive_unique) {
+  const char *dir = "replay_archive_test";
+  const char *paths[] = {"replay_archive_test/tetris-7.bgr",
+                         "replay_archive_test/tetris-7-1.bgr"};
+  Replay_t replay;
+  replayInit(&replay, REPLAY_TETRIS, 7);
+  replayInput(&replay, Start, false);
+  ck_assert(replayArchive(&replay, dir, 10));
+  ck_assert(replayArchive(&replay, dir, 20));
+  for (int i = 0; i < 2; i++) {
+    Replay_t loaded;
+    ck_assert(replayLoad(&loaded, paths[i]));
+    ck_assert_int_eq(loaded.score, 10 * (i + 1));
+    replayFree(&loaded);
+    remove(paths[i]);
+  }
+  ck_assert_int_eq(remove(dir), 0);
+  replayFree(&replay);
+}
+END_TEST
+
+Suite *test_replay(void) {
+  Suite *s;
+  s = suite_create("s21_replay");
+  TCase *tcase_replay = tcase_create("REPLAY");
+  tcase_add_test(tcase_replay, replay_encoding);
+  tcase_add_test(tcase_replay, replay_round_trip);
+  tcase_add_test(tcase_replay, replay_archive_unique);
+
+  suite_add_tcase(s, tcase_replay);
+  return s;
+}
+
+START_TEST(alloc_aligned) {
+  AllocStats_t before;
+  allocStatsTake(&before);
+  void *volatile block = aligned_alloc(64, 128);
+  free(block);
+  void *aligned = NULL;
+  ck_assert_int_eq(posix_memalign(&aligned, 64, 32), 0);
+  free(aligned);
+  Field_t field;
+  ck_assert(fieldCreate(&field, HEIGHT, WIDTH));
+  fieldDestroy(&field);
+
+  uint64_t counted = allocStatsEnabled() ? 3 : 0;
+  ck_assert_uint_eq(allocStatsSince(&before, ALLOC_PHASES), counted);
+}
+END_TEST
+
+START_TEST(alloc_phases) {
+  AllocStats_t before;
+  allocStatsTake(&before);
+  ck_assert_int_eq(allocPhaseCurrent(), ALLOC_IDLE);
+  AllocPhase_t tick = allocPhaseEnter(ALLOC_TICK);
+  AllocPhase_t spawn = allocPhaseEnter(ALLOC_SPAWN);
+  void *volatile block = malloc(16);
+  ck_assert_int_eq(allocPhaseCurrent(), ALLOC_SPAWN);
+  allocPhaseRestore(&spawn);
+  ck_assert_int_eq(allocPhaseCurrent(), ALLOC_TICK);
+  allocPhaseRestore(&tick);
+  ck_assert_int_eq(allocPhaseCurrent(), ALLOC_IDLE);
+  free(block);
+
+  uint64_t counted = allocStatsEnabled() ? 1 : 0;
+  ck_assert_uint_eq(allocStatsSince(&before, ALLOC_SPAWN), counted);
+  ck_assert_uint_eq(allocStatsSince(&before, ALLOC_TICK), 0);
+  ck_assert_uint_eq(allocStatsSince(&before, ALLOC_PHASES), counted);
+}
+END_TEST
+
+START_TEST(alloc_tetris_steady) {
+  Tetris game;
+  ck_assert_int_eq(initialGameSeeded(&game, 19), OK_);
+  userInput(&game, Start, false);
+  const UserAction_t actions[] = {Left, Action, Right, Right, Down};
+  AllocStats_t before = {{0}, {0}};
+  for (int i = 0; i < 3000 && game.gameInfo.pause == STARTED; i++) {
+    if (i == 100) allocStatsTake(&before);
+    userInput(&game, actions[i % 5], false);
+    updateCurrentState(&game);
+    takeFrameDiff(&game);
+  }
+  ck_assert_uint_gt(game.pieces, 10);
+  ck_assert_uint_eq(allocStatsSince(&before, ALLOC_PHASES), 0);
+  freeSpace(&game);
+}
+END_TEST
+
+Suite *test_alloc(void) {
+  Suite *s;
+  s = suite_create("s21_alloc");
+  TCase *tcase_alloc = tcase_create("ALLOC");
+  tcase_add_test(tcase_alloc, alloc_phases);
+  tcase_add_test(tcase_alloc, alloc_tetris_steady);
+  tcase_add_test(tcase_alloc, alloc_aligned);
+
+  suite_add_tcase(s, tcase_alloc);
+  return s;
+}
+
+START_TEST(latency_percentiles) {
+  static LatencyHistogram_t histogram;
+  latencyInit(&histogram);
+  ck_assert_int_eq(latencyPercentile(&histogram, 50), 0);
+  for (int64_t us = 1; us <= 100000; us++) latencyRecord(&histogram, us * 1000);
+  ck_assert_uint_eq(latencyCount(&histogram), 100000);
+  ck_assert_int_eq(latencyMax(&histogram), 100000000);
+  const double percentiles[] = {50, 90, 99, 99.9};
+  for (int i = 0; i < 4; i++) {
+    int64_t exact = (int64_t)(percentiles[i] * 1000000);
+    int64_t value = latencyPercentile(&histogram, percentiles[i]);
+    ck_assert_int_ge(value, exact);
+    ck_assert_int_le(value, exact + exact / LATENCY_SUB_BUCKETS);
+  }
+  ck_assert_int_eq(latencyPercentile(&histogram, 100), 100000000);
+
+  latencyInit(&histogram);
+  latencyRecord(&histogram, -5);
+  latencyRecord(&histogram, 3);
+  latencyRecord(&histogram, 7);
+  ck_assert_int_eq(latencyPercentile(&histogram, 0), 0);
+  ck_assert_int_eq(latencyPercentile(&histogram, 50), 3);
+  ck_assert_int_eq(latencyPercentile(&histogram, 99), 7);
+}
+END_TEST
+
+START_TEST(latency_format) {
+  const int64_t values[] = {0,       950,        1234,      12345,
+                            999999,  1500000,    45000000,  2500000000LL};
+  const char *texts[] = {"0n", "950n", "1.2u", "12u",
+                         "999u", "1.5m", "45m", "2.5s"};
+  char buffer[8];
+  for (int i = 0; i < 8; i++) {
+    latencyFormatNs(values[i], buffer, sizeof(buffer));
+    ck_assert_str_eq(buffer, texts[i]);
+  }
+
+  static LatencyHistogram_t histogram;
+  char line[17];
+  latencyInit(&histogram);
+  latencySummary(&histogram, 'T', line, sizeof(line));
+  ck_assert_str_eq(line, "T -");
+  latencyRecord(&histogram, 1200);
+  latencySummary(&histogram, 'T', line, sizeof(line));
+  ck_assert_str_eq(line, "T 1.2u/1.2u/1.2u");
+}
+END_TEST
+
+START_TEST(latency_key) {
+  static LatencyStats_t stats;
+  latencyStatsInit(&stats);
+  latencyKeyApplied(&stats, 50);
+  ck_assert_uint_eq(latencyCount(&stats.input), 0);
+  latencyKeyPressed(&stats, 100);
+  latencyKeyPressed(&stats, 200);
+  latencyKeyApplied(&stats, 350);
+  latencyKeyApplied(&stats, 400);
+  ck_assert_uint_eq(latencyCount(&stats.input), 1);
+  ck_assert_int_eq(latencyMax(&stats.input), 250);
+}
+END_TEST
+
+START_TEST(latency_tetris_sim) {
+  const char *path = "latency_test.log";
+  static LatencyStats_t stats;
+  Tetris game;
+  TetrisSim_t sim;
+  initialGameSeeded(&game, 5);
+  tetrisSimInit(&sim, &game, NULL, NULL);
+  latencyStatsInit(&stats);
+  ck_assert(latencyDump(&stats, "tetris", path));
+  sim.latency = &stats;
+  latencyKeyPressed(&stats, tickNow());
+  ck_assert(tetrisSimInput(&sim, Start, false));
+  tetrisSimRun(&sim);
+  ck_assert_uint_eq(latencyCount(&stats.input), 1);
+  ck_assert_uint_eq(latencyCount(&stats.tick), 0);
+  sim.ticks.lastNs -= 3 * sim.ticks.periodNs;
+  tetrisSimRun(&sim);
+  ck_assert_uint_eq(latencyCount(&stats.tick), 3);
+
+  remove(path);
+  ck_assert(latencyDump(&stats, "tetris", path));
+  FILE *file = fopen(path, "r");
+  ck_assert_ptr_nonnull(file);
+  char line[128];
+  int lines = 0;
+  while (fgets(line, sizeof(line), file)) {
+    ck_assert_int_eq(strncmp(line, "tetris ", 7), 0);
+    lines++;
+  }
+  fclose(file);
+  remove(path);
+  ck_assert_int_eq(lines, 3);
+  freeSpace(&game);
+}
+END_TEST
+
+Suite *test_latency(void) {
+  Suite *s;
+  s = suite_create("s21_latency");
+  TCase *tcase_latency = tcase_create("LATENCY");
+  tcase_add_test(tcase_latency, latency_percentiles);
+  tcase_add_test(tcase_latency, latency_format);
+  tcase_add_test(tcase_latency, latency_key);
+  tcase_add_test(tcase_latency, latency_tetris_sim);
+
+  suite_add_tcase(s, tcase_latency);
+  return s;
+}
+
+/**
+ * @brief Читает файл трассировки и считает вхождения строки.
+ *
+ * @param path Путь к файлу.
+ * @param needle Искомая строка.
+ * @return int Количество вхождений (-1 - файл не прочитан или не JSON).
+ */
+static int trace_count(const char *path, const char *needle) {
+  int found = -1;
+  FILE *file = fopen(path, "r");
+  if (file) {
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = (char *)calloc((size_t)size + 1, 1);
+    if (fread(text, 1, (size_t)size, file) == (size_t)size &&
+        strncmp(text, "{\"traceEvents\":[", 16) == 0 &&
+        strstr(text, "],\"displayTimeUnit\":\"ns\"}")) {
+      found = 0;
+      for (char *at = strstr(text, needle); at;
+           at = strstr(at + 1, needle)) {
+        found++;
+      }
+    }
+    free(text);
+    fclose(file);
+  }
+  return found;
+}
+
+static void *trace_thread(void *arg) {
+  (void)arg;
+  TraceSpan_t span = traceSpanBegin("trace_thread");
+  traceSpanEnd(&span);
+  return NULL;
+}
+
+START_TEST(trace_threads) {
+  const char *path = "trace_test.json";
+  TraceSpan_t span = traceSpanBegin("trace_main");
+  traceSpanEnd(&span);
+  pthread_t thread;
+  ck_assert_int_eq(pthread_create(&thread, NULL, trace_thread, NULL), 0);
+  pthread_join(thread, NULL);
+  ck_assert(traceFlush(path));
+  ck_assert_int_eq(trace_count(path, "\"name\":\"trace_main\""), 1);
+  ck_assert_int_eq(trace_count(path, "\"name\":\"trace_thread\""), 1);
+  ck_assert_int_eq(trace_count(path, "\"ph\":\"X\""),
+                   trace_count(path, "\"dur\":"));
+  remove(path);
+  ck_assert(!traceFlush("no_such_dir/trace_test.json"));
+}
+END_TEST
+
+START_TEST(trace_ring_wrap) {
+  const char *path = "trace_test.json";
+  for (int k = 0; k < TRACE_RING_EVENTS + 10; k++) {
+    TraceSpan_t span = traceSpanBegin("trace_wrap");
+    traceSpanEnd(&span);
+  }
+  ck_assert(traceFlush(path));
+  ck_assert_int_eq(trace_count(path, "\"name\":\"trace_wrap\""),
+                   TRACE_RING_EVENTS - 1);
+  remove(path);
+}
+END_TEST
+
+START_TEST(trace_tetris_phases) {
+  const char *path = "trace_test.json";
+  Tetris game;
+  initialGameSeeded(&game, 5);
+  userInput(&game, Start, false);
+  updateCurrentState(&game);
+  ck_assert(traceFlush(path));
+  int expected = traceEnabled() ? 1 : 0;
+  ck_assert_int_ge(trace_count(path, "\"name\":\"userInput\""), expected);
+  ck_assert_int_ge(trace_count(path, "\"name\":\"updateCurrentState\""),
+                   expected);
+  if (!traceEnabled()) {
+    ck_assert(!traceInstall(path));
+  }
+  remove(path);
+  freeSpace(&game);
+}
+END_TEST
+
+Suite *test_trace(void) {
+  Suite *s;
+  s = suite_create("s21_trace");
+  TCase *tcase_trace = tcase_create("TRACE");
+  tcase_add_test(tcase_trace, trace_threads);
+  tcase_add_test(tcase_trace, trace_ring_wrap);
+  tcase_add_test(tcase_trace, trace_tetris_phases);
+
+  suite_add_tcase(s, tcase_trace);
+  return s;
+}
+
 // MAIN //
 static int run_test_suite(Suite *test_suite) {
   int number_failed = 0;
@@ -553,6 +1588,14 @@ int main(void) {
       test_game_user_input_action(),
       test_game_changing_score(),
       test_game_locking_figures(),
+      test_bot(),
+      test_batch(),
+      test_replay(),
+      test_tick(),
+      test_sim(),
+      test_alloc(),
+      test_latency(),
+      test_trace(),
 
       NULL};
 